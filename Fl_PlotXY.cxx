@@ -1,4 +1,4 @@
-const char VERSION_FL_PLOTXY[] = "V1.0.13";
+const char VERSION_FL_PLOTXY[] = "V1.1.0";
 /******************************************************************
 *                        FL_PlotXY.cxx
 *
@@ -24,6 +24,70 @@ const char VERSION_FL_PLOTXY[] = "V1.0.13";
 *******************************************************************
 *                   Version Information
 *******************************************************************
+* Version 1.1.0 - 17 October 2026
+*  Line storage grows geometrically - add is O(1) amortized.
+*   reserve, capacity, shrink_to_fit
+*  Added block add of X/Y arrays, interleaved and strided data.
+*  read and change index the point directly instead of walking to it.
+*  Added points to get read-only access to a line's data.
+*  Added maxpoints to keep a line as a fixed size ring buffer.
+*  Line min/max is kept as points are added instead of scanning
+*   all the data on every draw.
+*  Added FL_PLOTXY_DECIMATE drawing mode - draws a min/max per
+*   pixel column so big lines draw as fast as small ones.
+*  Added pyramid to keep min/max of blocks of 64, 4096 and 262144
+*   points, so decimated drawing of huge lines reads only a few
+*   blocks per pixel column.
+*  Lines and dots are drawn as polylines/point lists of up to 1024
+*   vertices, dropping vertices on the same pixel as the last one.
+*  Traces, axes and labels are drawn once into an offscreen cache,
+*   only the vertical line is drawn on top each time.
+*   invalidate, cacheenable, draw_overlay
+*  Points added to lines whose scale did not change are drawn onto
+*   the cache on their own.
+*   redraw_append, FL_PLOTXY_DAMAGE_APPEND
+*  Added FL_PLOTXY_STRIP scale mode - a scrolling strip chart that
+*   moves the cached traces along and draws only the new points.
+*  Added columnar to keep a line's X and Y values in separate arrays.
+*   Scans and drawing work down each column on its own.
+*   columns gives read-only access to either layout.
+*  Min/max scans and pixel positions use SSE2, AVX2 or AVX-512 kernels
+*   picked from what the CPU supports. simd
+*  Lines can store X and Y values as float, or as 16 or 32 bit integers
+*   with a gain and offset. xstore, ystore
+*  Added xuniform for lines sampled at a fixed X step - only Y is
+*   stored and only the samples on the plot are drawn.
+*  Added attach to show a caller's buffer without copying it.
+*   detach, attached
+*  No limit on the number of lines - line slots are added as needed,
+*   removed line numbers are handed out again and drawing only goes
+*   through the lines shown. loadxyyy takes any number of columns. lines
+*  Added groups of lines sharing one X column, added a row at a time.
+*   X is stored once and worked out in pixels once for all the lines.
+*   loadxyyy loads the columns as a group. newgroup, add_row,
+*   removegroup, linegroup
+*  Point storage and loadxyyy labels come from a pool kept by each
+*   widget - clearing and loading again reuses the blocks rather than
+*   freeing and allocating. poolsize
+*  Added segmented lines, kept in chunks of 64K points that never move.
+*   Growing adds a chunk and a ring buffer drops whole chunks, scans
+*   and drawing go a chunk at a time. segmented
+*  load and loadxyyy map the file and parse it in place, any row length,
+*   the same numbers in any locale. Rows are counted first so the lines
+*   are the right size from the start. HH:MM:SS reads the seconds.
+*  Big files load on a thread per processor, each parsing a part of the
+*   file, the parts added to the lines in order. loadthreads
+*  Added add_rows to add a block of rows to a group.
+*  Added the binary .pxy file - line settings, the values as stored,
+*   the data range and pyramids. loadpxy maps the file and shows it
+*   in place. savepxy loadpxy
+*  save and savexyyy write blocks of rows on a thread per processor,
+*   each number with the fewest digits that read back to the same
+*   value, not six places.
+*  Added loadasync, loadxyyyasync, saveasync and savexyyyasync to load
+*   and save on a thread in the background, told how it goes on the
+*   FLTK thread. asynccallback, asyncpreview, asynccancel, asyncbusy
+*******************************************************************
 * Version 1.0.13 - 14 April 2005
 * Start Adding Vertical value finder.
 *******************************************************************
@@ -95,2064 +159,7978 @@ const char VERSION_FL_PLOTXY[] = "V1.0.13";
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <locale.h>
 
 #include "Fl_PlotXY.H"
+#include <FL/Fl.H>
 
 #ifdef WIN32
 #include <windows.h>
 #else
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "Rotated.H"
 #endif
 
 int P_DEBUG = 0;
 
 /************************************************************************
-*                          Fl_PlotXY
+*                          line_phys
+* Position in storage of point p (point 0 is the oldest).
+* Ring buffer lines start at DataStart and wrap at MaxPoints.
+* Segmented lines start DataStart into their first chunk and never wrap.
 ************************************************************************/
-Fl_PlotXY::Fl_PlotXY(int X, int Y, int W, int H, const char *l)
-    : Fl_Widget(X, Y, W, H, l)
+static inline unsigned long int line_phys(const Fl_PlotXY_Line *L, unsigned long int p)
 {
-    int count;
+    p += L->DataStart;
+    if (L->MaxPoints != 0 && !L->Segmented && p >= L->MaxPoints)
+        p -= L->MaxPoints;
+    return (p);
+}
 
-    /* Border box to start with */
-    box(FL_EMBOSSED_BOX);
-    color(FL_WHITE);
+/************************************************************************
+*                          line_run
+* Points [first,last) may wrap around the end of a ring buffer, or
+* run on into the next chunk of a segmented line.
+* Returns how many of them lie together in storage from `first'
+* and sets p to the position of the first of them.
+************************************************************************/
+static unsigned long int line_run(const Fl_PlotXY_Line *L, unsigned long int first, unsigned long int last, unsigned long int *p)
+{
+    unsigned long int n;
 
-    /* Set Basic Fonts and Sizes */
-    AxisFontSize = 12;
-    AxisFontFace = FL_HELVETICA;
-    /* Other Options are FL_HELVETICA, FL_COURIER, FL_TIMES, FL_SCREEN */
+    *p = line_phys(L, first);
+    n = last - first;
+    if (L->YCol.Chunk != NULL)
+    {
+        if (n > FL_PLOTXY_CHUNK - (*p & (FL_PLOTXY_CHUNK - 1)))
+            n = FL_PLOTXY_CHUNK - (*p & (FL_PLOTXY_CHUNK - 1));
+    }
+    else if (L->MaxPoints != 0 && n > L->MaxPoints - *p)
+        n = L->MaxPoints - *p;
 
-    AxisTextSpaceX = 15; /* Text space for X Axis Display */
-    AxisTextSpaceY = 60; /* Text Spaceing for Y Axis Display */
+    return (n);
+}
+
+/************************************************************************
+*                          Columns
+* A line keeps its points either interleaved in data, or columnar in
+* Cols - all the X values then all the Y values.
+* XCol and YCol say where the first X and Y value are, how many bytes
+* apart and what type they are stored as. Only FL_PLOTXY_DOUBLE
+* values can be interleaved.
+* A FL_PLOTXY_UNIFORM X column stores nothing - the X of a position
+* comes from its sample number, counted on from the oldest point.
+* A segmented line has the same layout in each of its chunks, Chunk
+* says where they are and Skip where the column starts in each.
+************************************************************************/
 
-    /* Initialise Data */
-    for (count = 0; count < FL_PLOTXY_MAXLINES; count++)
+/* Bytes taken by one value of a storage type */
+static inline int col_size(int type)
+{
+    switch (type)
     {
-        LineData[count].LineNumber = -1;            /* Line Number for this array        */
-        LineData[count].DrawMode = FL_PLOTXY_LINE;  /* Line Drawing Mode          */
-        LineData[count].ScaleMode = FL_PLOTXY_AUTO; /* Scaling Mode               */
+    case FL_PLOTXY_FLOAT:
+        return (sizeof(float));
+    case FL_PLOTXY_INT16:
+        return (sizeof(short));
+    case FL_PLOTXY_INT32:
+        return (sizeof(int));
+    case FL_PLOTXY_UNIFORM:
+        return (0);
+    default:
+        return (sizeof(double));
+    }
+}
 
-        LineData[count].Xmax = 0.0; /* Maximum Axis Value for this line  */
-        LineData[count].Ymax = 0.0;
-        LineData[count].Xmin = 0.0; /* Minimum Axis Value for this line  */
-        LineData[count].Ymin = 0.0;
-        LineData[count].title = NULL; /* Pointer to string array for title */
-        LineData[count].C = FL_BLACK; /* Line and title Colour             */
+/* Where the value at position p is kept */
+static inline char *col_at(const Fl_PlotXY_Column *C, unsigned long int p)
+{
+    if (C->Chunk != NULL)
+        return (C->Chunk[p >> FL_PLOTXY_CHUNK_SHIFT] + C->Skip + (p & (FL_PLOTXY_CHUNK - 1)) * C->Stride);
+    return (C->Data + p * C->Stride);
+}
 
-        LineData[count].DataSize = 0; /* Number of Points in array         */
-        LineData[count].data = NULL;  /* Pointer to data for this line     */
+/* Positions from p up to the end of its chunk, all of them if not segmented */
+static inline unsigned long int col_room(const Fl_PlotXY_Column *C, unsigned long int p)
+{
+    if (C->Chunk != NULL)
+        return (FL_PLOTXY_CHUNK - (p & (FL_PLOTXY_CHUNK - 1)));
+    return ((unsigned long int)-1);
+}
 
-        LineData[count].XLabel = NULL; /* Pointer to string for X label     */
-        LineData[count].YLabel = NULL; /* Pointer to string for Y label     */
+/* Value at position p */
+static inline double col_get(const Fl_PlotXY_Column *C, unsigned long int p)
+{
+    const char *V = col_at(C, p);
 
-        sprintf(LineData[count].XValFormat, "%%0.02lf"); /* Formatter for X Value display */
-        sprintf(LineData[count].YValFormat, "%%0.02lf"); /* Formatter for Y Value display */
+    switch (C->Type)
+    {
+    case FL_PLOTXY_FLOAT:
+        return (*(const float *)V);
+    case FL_PLOTXY_INT16:
+        return (*(const short *)V * C->Gain + C->Offset);
+    case FL_PLOTXY_INT32:
+        return (*(const int *)V * C->Gain + C->Offset);
+    case FL_PLOTXY_UNIFORM:
+        return (C->Offset + C->Gain * (C->Base + (double)(p >= C->Wrap ? p - C->Wrap : p + C->Span - C->Wrap)));
+    default:
+        return (*(const double *)V);
     }
+}
 
-    /* Dont have any line shown */
-    vlinepos(0);
-    vlineenable(0);
-    vlinesel(-1);
+/* Store a value at position p, integers to the nearest step in range */
+static inline void col_set(Fl_PlotXY_Column *C, unsigned long int p, double v)
+{
+    char *V = col_at(C, p);
+
+    switch (C->Type)
+    {
+    case FL_PLOTXY_FLOAT:
+        *(float *)V = (float)v;
+        break;
+
+    case FL_PLOTXY_INT16:
+        v = floor((v - C->Offset) / C->Gain + 0.5);
+        *(short *)V = v >= 32767.0 ? 32767 : v <= -32768.0 ? -32768 : v == v ? (short)v : 0;
+        break;
+
+    case FL_PLOTXY_INT32:
+        v = floor((v - C->Offset) / C->Gain + 0.5);
+        *(int *)V = v >= 2147483647.0 ? 2147483647 : v <= -2147483648.0 ? (-2147483647 - 1) : v == v ? (int)v : 0;
+        break;
+
+    case FL_PLOTXY_UNIFORM:
+        break; /* Comes from the sample number */
+
+    default:
+        *(double *)V = v;
+        break;
+    }
 }
 
-/************************************************************************
-*                          ~Fl_PlotXY
-************************************************************************/
-Fl_PlotXY::~Fl_PlotXY(void)
+/* X and Y of the point at position p */
+static inline double col_x(const Fl_PlotXY_Line *L, unsigned long int p)
 {
-    removeall(); /* Free All allocated memory */
+    return (col_get(&L->XCol, p));
 }
 
-/************************************************************************
-*                          version
-************************************************************************/
-const char *Fl_PlotXY::version(void)
+static inline double col_y(const Fl_PlotXY_Line *L, unsigned long int p)
 {
-    return (VERSION_FL_PLOTXY);
+    return (col_get(&L->YCol, p));
 }
 
-/************************************************************************
-*                          getselected
-* returns pointer to data selected by int
-* returns NULL if invalid
-************************************************************************/
-Fl_PlotXY_Line *Fl_PlotXY::getselected(int line)
+/* Point X and Y at interleaved storage D, or columnar storage C, of cap points */
+static void col_place(Fl_PlotXY_Column *X, Fl_PlotXY_Column *Y, Fl_PlotXY_Data *D, char *C, unsigned long int cap)
 {
-    if (P_DEBUG > 1)
-        printf("Fl_PlotXY::getselected(int line)\n");
+    X->Chunk = Y->Chunk = NULL;
+    if (D != NULL)
+    {
+        X->Data = (char *)&D->X;
+        Y->Data = (char *)&D->Y;
+        X->Stride = Y->Stride = sizeof(Fl_PlotXY_Data);
+    }
+    else
+    {
+        X->Stride = col_size(X->Type);
+        Y->Stride = col_size(Y->Type);
+        X->Data = C;
+        Y->Data = C != NULL ? C + cap * X->Stride : NULL;
+    }
+}
 
-    if (line >= FL_PLOTXY_MAXLINES || line < 0)
-        return (NULL);
+/* Point X and Y at the count chunks in T, each laid out as interleaved
+ * points or columnar */
+static void col_chunks(Fl_PlotXY_Column *X, Fl_PlotXY_Column *Y, char **T, unsigned long int count, int columnar)
+{
+    if (!columnar)
+    {
+        X->Skip = 0;
+        Y->Skip = sizeof(double); /* Y follows X in Fl_PlotXY_Data */
+        X->Stride = Y->Stride = sizeof(Fl_PlotXY_Data);
+    }
+    else
+    {
+        X->Stride = col_size(X->Type);
+        Y->Stride = col_size(Y->Type);
+        X->Skip = 0;
+        Y->Skip = FL_PLOTXY_CHUNK * X->Stride;
+    }
 
-    if (LineData[line].LineNumber == -1)
-        return (NULL);
+    X->Chunk = Y->Chunk = count != 0 ? T : NULL;
+    X->Data = count != 0 ? T[0] + X->Skip : NULL;
+    Y->Data = count != 0 ? T[0] + Y->Skip : NULL;
+}
 
-    return (&LineData[line]);
+/* Point XCol and YCol at the storage in use - an attached buffer stays put */
+static void line_cols(Fl_PlotXY_Line *L)
+{
+    if (!L->External)
+    {
+        if (L->Segmented)
+            col_chunks(&L->XCol, &L->YCol, L->Chunk, L->Chunks, L->Columnar);
+        else
+            col_place(&L->XCol, &L->YCol, L->Columnar ? NULL : L->data, L->Cols, L->DataCapacity);
+    }
+    L->XCol.Wrap = L->YCol.Wrap = L->DataStart;
+    L->XCol.Span = L->YCol.Span = L->Segmented ? 0 : L->MaxPoints;
 }
 
-/************************************************************************
-*                          newline
-* Create a new Data set
-* returns descripter to line
-************************************************************************/
-int Fl_PlotXY::newline(double Xmin, double Ymin, double Xmax, double Ymax, int scalemode, Fl_Color C, const char *t)
+/* Bytes taken by one point of a line */
+static inline unsigned long int line_pointsize(const Fl_PlotXY_Line *L)
 {
-    int count;
-    Fl_PlotXY_Line *L;
+    return (col_size(L->XCol.Type) + col_size(L->YCol.Type));
+}
 
-    if (P_DEBUG > 1)
-        printf("Fl_PlotXY::newline(double,double,double,double,Fl_Color,cont char*\n");
+/* Store n doubles, sstep apart, from position p on - a chunk at a time */
+static void col_put(Fl_PlotXY_Column *C, unsigned long int p, const double *S, int sstep, unsigned long int n)
+{
+    unsigned long int count, c;
 
-    /* Scan array for first free data */
-    for (count = 0; count < FL_PLOTXY_MAXLINES; count++)
+    for (; n > 0; n -= c, p += c)
     {
-        /* Create the New Data */
-        if (LineData[count].LineNumber != count)
+        c = col_room(C, p);
+        if (c > n)
+            c = n;
+
+        if (C->Type == FL_PLOTXY_DOUBLE && C->Stride == sizeof(double) && sstep == 1)
         {
-            L = &LineData[count];
+            memcpy(col_at(C, p), S, sizeof(double) * c);
+            S += c;
+            continue;
+        }
 
-            L->LineNumber = count;
-            L->DrawMode = FL_PLOTXY_LINE; /* Line Drawing Mode         */
+        for (count = 0; count < c; count++, S += sstep)
+            col_set(C, p + count, *S);
+    }
+}
 
-            L->ScaleMode = scalemode;
+/* Copy n values from position sp of S to position dp of D, converting if the types differ */
+static void col_move(Fl_PlotXY_Column *D, unsigned long int dp, const Fl_PlotXY_Column *S, unsigned long int sp, unsigned long int n)
+{
+    unsigned long int count, c;
+    int size = col_size(S->Type);
 
-            L->Displayed = 1; /* Turn Line Display ON */
+    if (D->Type == FL_PLOTXY_UNIFORM)
+        return; /* Nothing stored */
 
-            L->XMark = 0;       /* X Graduation Marks off         */
-            L->YMark = 0;       /* Y Graduation Marks off         */
-            L->XMarkSize = 0.0; /* X Graduation step  off         */
-            L->YMarkSize = 0.0; /* Y Graduation step  off         */
+    if (D->Type != S->Type || D->Gain != S->Gain || D->Offset != S->Offset)
+    {
+        for (count = 0; count < n; count++)
+            col_set(D, dp + count, col_get(S, sp + count));
+        return;
+    }
 
-            L->XValType = 0; /* Type of data for X Axis Value     */
-            L->YValType = 0; /* Type of data for Y Axis Value     */
+    /* Runs that stay within a chunk of both */
+    for (; n > 0; n -= c, dp += c, sp += c)
+    {
+        c = col_room(D, dp);
+        if (c > col_room(S, sp))
+            c = col_room(S, sp);
+        if (c > n)
+            c = n;
 
-            if (Xmin < Xmax)
-            {
-                L->Xmax = Xmax;
-                L->Xmin = Xmin;
-            }
-            else
-            {
-                L->Xmax = Xmin;
-                L->Xmin = Xmax;
-            }
+        if (D->Stride == size && S->Stride == size)
+        {
+            memcpy(col_at(D, dp), col_at(S, sp), size * c);
+            continue;
+        }
 
-            if (Ymin < Ymax)
-            {
-                L->Ymax = Ymax;
-                L->Ymin = Ymin;
-            }
-            else
-            {
-                L->Ymax = Ymin;
-                L->Ymin = Ymax;
-            }
+        for (count = 0; count < c; count++)
+            memcpy(col_at(D, dp + count), col_at(S, sp + count), size);
+    }
+}
 
-            L->title = t; /* Pointer to string array for title */
-            L->C = C;     /* Line and title Colour             */
+/************************************************************************
+*                          Pool
+* Point storage comes from the widget's pool. A freed block goes on the
+* free list of its size, for the next block of that size, until the
+* pool holds Limit bytes - past that it goes back to the system.
+* Each block starts with its size class, the storage follows.
+************************************************************************/
+#define FL_PLOTXY_POOL_HEADER 16 /* Keeps the storage 16 byte aligned */
+#define FL_PLOTXY_POOL_FIRST 16  /* Smallest class used, 64 bytes */
+/* Classes whose size an unsigned long holds - 32 bit on WIN32 */
+#define FL_PLOTXY_POOL_FITS (4 * ((int)(sizeof(unsigned long int) * CHAR_BIT) - 3))
 
-            L->DataSize = 0; /* Number of Points in array         */
+/* Bytes in a block of class c */
+static inline unsigned long int pool_bytes(int c)
+{
+    return ((unsigned long int)(4 + (c & 3)) << (c >> 2));
+}
 
-            /* Allocate at least one lot of data even though not used */
-            L->data = (Fl_PlotXY_Data *)realloc(L->data, sizeof(Fl_PlotXY_Data));
+/* Smallest class holding size bytes, FL_PLOTXY_POOL_CLASSES if none */
+static int pool_class(unsigned long int size)
+{
+    int c = FL_PLOTXY_POOL_FIRST;
 
-            return (count);
-        }
-    }
+    while (c < FL_PLOTXY_POOL_CLASSES && c < FL_PLOTXY_POOL_FITS && pool_bytes(c) < size)
+        c++;
+    return (c < FL_PLOTXY_POOL_FITS ? c : FL_PLOTXY_POOL_CLASSES);
+}
 
-    if (P_DEBUG > 0)
-        printf(" ERROR: Out of line allocations\n");
-    return (-1);
+/* Class of a block in use */
+static inline int pool_classof(const void *p)
+{
+    return (*(const int *)((const char *)p - FL_PLOTXY_POOL_HEADER));
 }
 
-/************************************************************************
-*                            add
-* Add data to selected line
-************************************************************************/
-int Fl_PlotXY::add(int line, double X, double Y)
+static void *pool_alloc(Fl_PlotXY_Pool *P, unsigned long int size)
 {
-    unsigned long int ds;
-    Fl_PlotXY_Line *L;
-    Fl_PlotXY_Data *D;
+    char *b;
+    int c;
 
-    if (P_DEBUG > 1)
-        printf("Fl_PlotXY::add(int,double,double)\n");
+    if ((c = pool_class(size)) >= FL_PLOTXY_POOL_CLASSES ||
+        pool_bytes(c) > (unsigned long int)-1 - FL_PLOTXY_POOL_HEADER)
+        return (NULL);
 
-    if ((L = getselected(line)) == NULL)
-        return 0; /* Get Data */
+    if ((b = (char *)P->Free[c]) != NULL)
+    {
+        /* One of this size freed before */
+        P->Free[c] = *(void **)(b + FL_PLOTXY_POOL_HEADER);
+        P->Kept -= pool_bytes(c);
+    }
+    else
+    {
+        if ((b = (char *)malloc(pool_bytes(c) + FL_PLOTXY_POOL_HEADER)) == NULL)
+            return (NULL);
+        *(int *)b = c;
+    }
 
-    ds = L->DataSize; /* Get Data Size   */
-    D = L->data;      /* Pointer to data */
+    return (b + FL_PLOTXY_POOL_HEADER);
+}
+
+static void pool_free(Fl_PlotXY_Pool *P, void *p)
+{
+    char *b;
+    int c;
+
+    if (p == NULL)
+        return;
 
-    /* Go To Data Location */
-    while (ds > 0)
+    b = (char *)p - FL_PLOTXY_POOL_HEADER;
+    c = pool_classof(p);
+    if (P->Kept > P->Limit || pool_bytes(c) > P->Limit - P->Kept)
     {
-        ds--;
-        D++;
+        free(b); /* Pool full */
+        return;
     }
 
-    /* Add New Data */
-    D->X = X;
-    D->Y = Y;
+    *(void **)p = P->Free[c];
+    P->Free[c] = b;
+    P->Kept += pool_bytes(c);
+}
 
-    L->DataSize++;
+/* Storage of size bytes keeping what p held - p itself if it is the
+ * same size class. NULL if there is no room, p is still valid then */
+static void *pool_realloc(Fl_PlotXY_Pool *P, void *p, unsigned long int size)
+{
+    void *n;
+    unsigned long int keep;
 
-    if (P_DEBUG > 1)
-        printf(" DataSize=%ld  -> %ld bytes\n", L->DataSize, L->DataSize * sizeof(Fl_PlotXY_Data));
+    if (p == NULL)
+        return (pool_alloc(P, size));
+    if (pool_class(size) == pool_classof(p))
+        return (p);
+
+    if ((n = pool_alloc(P, size)) == NULL)
+        return (NULL);
+    keep = pool_bytes(pool_classof(p));
+    memcpy(n, p, keep < size ? keep : size);
+    pool_free(P, p);
+    return (n);
+}
 
-    /* Allocate More memory */
-    D = (Fl_PlotXY_Data *)realloc(L->data, sizeof(Fl_PlotXY_Data) * (L->DataSize + 1));
+/* Give free blocks back to the system until the pool holds at most limit bytes */
+static void pool_trim(Fl_PlotXY_Pool *P, unsigned long int limit)
+{
+    char *b;
+    int c;
 
-    if (D == NULL)
+    for (c = FL_PLOTXY_POOL_CLASSES - 1; c >= 0 && P->Kept > limit; c--)
     {
-        if (P_DEBUG > 0)
-            printf(" ERROR: Not Enough Space\n");
-        /* Not Enough Space!! */
-        L->DataSize--;
-        return (0);
+        while ((b = (char *)P->Free[c]) != NULL && P->Kept > limit)
+        {
+            P->Free[c] = *(void **)(b + FL_PLOTXY_POOL_HEADER);
+            P->Kept -= pool_bytes(c);
+            free(b);
+        }
     }
-    else
+}
+
+/* Copy the first n characters of s as a label string, NULL if no room.
+ * Strings stay until pool_text_reset. */
+static char *pool_string(Fl_PlotXY_Pool *P, const char *s, unsigned long int n)
+{
+    Fl_PlotXY_Text *T;
+    char *t;
+
+    for (T = P->Text; T != NULL && T->Size - T->Used < n + 1; T = T->Next)
+        ;
+    if (T == NULL)
     {
-        if (P_DEBUG > 1)
-            printf(" New Memory allocated\n");
-        /* Point to new Allocated Memory */
-        L->data = D;
+        /* New block at the front */
+        if ((T = (Fl_PlotXY_Text *)malloc(sizeof(Fl_PlotXY_Text) + (n < 4096 ? 4096 : n + 1))) == NULL)
+            return (NULL);
+        T->Size = n < 4096 ? 4096 : n + 1;
+        T->Used = 0;
+        T->Next = P->Text;
+        P->Text = T;
     }
-    return (1);
+
+    t = (char *)(T + 1) + T->Used;
+    memcpy(t, s, n);
+    t[n] = 0;
+    T->Used += n + 1;
+    return (t);
 }
 
-/************************************************************************
-*                          linecolor
-* Set Line Colour
-************************************************************************/
-int Fl_PlotXY::linecolor(int line, Fl_Color C)
+/* All label strings are finished with, their blocks are used again */
+static void pool_text_reset(Fl_PlotXY_Pool *P)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 1)
-        printf("Fl_PlotXY::linecolor(int line,Fl_Color C)\n");
-    if ((L = getselected(line)) == NULL)
-        return 0; /* Get Data */
-    
-    L->C = C;     /* Set Colour */
-    return (1);
+    Fl_PlotXY_Text *T;
+
+    for (T = P->Text; T != NULL; T = T->Next)
+        T->Used = 0;
 }
 
-/************************************************************************
-*                          linecolor
-* Return Line colour
-************************************************************************/
-Fl_Color Fl_PlotXY::linecolor(int line)
+/* Give everything back to the system */
+static void pool_release(Fl_PlotXY_Pool *P)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 1)
-        printf("Fl_PlotXY::linecolor(int line)\n");
-    if ((L = getselected(line)) == NULL)
-        return (FL_BLACK); /* Get Data */
-    return (L->C);
+    Fl_PlotXY_Text *T;
+
+    pool_trim(P, 0);
+    while ((T = P->Text) != NULL)
+    {
+        P->Text = T->Next;
+        free(T);
+    }
 }
 
 /************************************************************************
-*                          setrange
-* Set lines range
+*                          Chunks
+* A segmented line keeps its points in chunks of FL_PLOTXY_CHUNK points
+* taken from the pool. Filled chunks are never moved - growing adds
+* chunks at the end, and a ring buffer gives the first one back once
+* all its points have been dropped, moving DataStart back a chunk.
 ************************************************************************/
-int Fl_PlotXY::setrange(int line, double Xmin, double Ymin, double Xmax, double Ymax)
+
+/* Give back all the chunks of a line */
+static void chunk_free(Fl_PlotXY_Line *L)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 1)
-        printf("Fl_PlotXY::setrange(int line,double Xmin,double Ymin,double Xmax,double Ymax)\n");
-    if ((L = getselected(line)) == NULL)
-        return 0; /* Get Data */
+    unsigned long int count;
 
-    /* Set the Min and Max values - check for correct way around */
-    if (Xmin < Xmax)
-    {
-        L->Xmin = Xmin;
-        L->Xmax = Xmax;
-    }
-    else
-    {
-        L->Xmin = Xmax;
-        L->Xmax = Xmin;
-    }
+    for (count = 0; count < L->Chunks; count++)
+        pool_free(L->Pool, L->Chunk[count]);
+    free(L->Chunk);
+    L->Chunk = NULL;
+    L->Chunks = L->ChunkSlots = 0;
+}
 
-    if (Ymin < Ymax)
+/* Add chunks until there is room for cap points after DataStart.
+ * Chunks added before a failure are kept for the next try. */
+static int chunk_add(Fl_PlotXY_Line *L, unsigned long int cap)
+{
+    unsigned long int need, slots;
+    char **T, *C;
+
+    if (cap > (unsigned long int)-1 - FL_PLOTXY_CHUNK - L->DataStart)
+        return (0); /* Would overflow */
+
+    need = (L->DataStart + cap + FL_PLOTXY_CHUNK - 1) >> FL_PLOTXY_CHUNK_SHIFT;
+    if (need > L->ChunkSlots)
     {
-        L->Ymin = Ymin;
-        L->Ymax = Ymax;
+        slots = L->ChunkSlots ? L->ChunkSlots : 16;
+        while (slots < need)
+            slots *= 2;
+        if ((T = (char **)realloc(L->Chunk, slots * sizeof(char *))) == NULL)
+            return (0);
+        L->Chunk = T;
+        L->ChunkSlots = slots;
     }
-    else
+
+    while (L->Chunks < need)
     {
-        L->Ymin = Ymax;
-        L->Ymax = Ymin;
+        if ((C = (char *)pool_alloc(L->Pool, FL_PLOTXY_CHUNK * line_pointsize(L))) == NULL)
+            break;
+        L->Chunk[L->Chunks++] = C;
     }
-    return (1);
+
+    L->DataCapacity = (L->Chunks << FL_PLOTXY_CHUNK_SHIFT) - L->DataStart;
+    line_cols(L);
+    return (L->Chunks == need);
+}
+
+/* Give back the chunks after the one holding the newest point */
+static void chunk_trim(Fl_PlotXY_Line *L)
+{
+    unsigned long int need;
+
+    need = (L->DataStart + L->DataSize + FL_PLOTXY_CHUNK - 1) >> FL_PLOTXY_CHUNK_SHIFT;
+    while (L->Chunks > need)
+        pool_free(L->Pool, L->Chunk[--L->Chunks]);
+
+    L->DataCapacity = (L->Chunks << FL_PLOTXY_CHUNK_SHIFT) - L->DataStart;
+    line_cols(L);
 }
 
 /************************************************************************
-*                          getrange
-* Returns range from current mode
+*                          store_free
+* Free the line's storage, whichever layout, or let go of the
+* caller's buffer
 ************************************************************************/
-int Fl_PlotXY::getrange(int line, double *Xmin, double *Ymin, double *Xmax, double *Ymax)
+static void store_free(Fl_PlotXY_Line *L)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 1)
-        printf("Fl_PlotXY::getrange(int line, double* X,double* Y,double* X2,double* Y2)\n");
+    if (L->External)
+    {
+        L->External = 0;
+        L->XCol.Data = L->YCol.Data = NULL;
 
-    if ((L = getselected(line)) == NULL)
-        return 0; /* Get Data */
-
-    switch (L->ScaleMode)
-    {
-    default:
-    case FL_PLOTXY_AUTO:
-        minmax(L);
-        *Xmin = MinX;
-        *Xmax = MaxX;
-        *Ymin = MinY;
-        *Ymax = MaxY;
-        break;
+        /* Pyramid levels in the buffer go with it */
+        if (L->Pyramid != NULL && L->Pyramid->Mapped)
+            memset(L->Pyramid, 0, sizeof(Fl_PlotXY_Pyramid));
 
-    case FL_PLOTXY_FIXED:
-        *Xmin = L->Xmin;
-        *Xmax = L->Xmax;
-        *Ymin = L->Ymin;
-        *Ymax = L->Ymax;
-        break;
+        if (L->Release != NULL)
+            L->Release(L->ReleaseArg);
+        L->Release = NULL;
+        L->ReleaseArg = NULL;
     }
-    return (1);
+
+    pool_free(L->Pool, L->data);
+    pool_free(L->Pool, L->Cols);
+    chunk_free(L);
+    L->data = NULL;
+    L->Cols = NULL;
+    L->DataCapacity = 0;
+    L->DataStart = 0;
+    line_cols(L);
 }
 
 /************************************************************************
-*                          scalemode
-*Sets the scale mode
+*                          store_resize
+* Change the storage of a line that is not a ring buffer to cap points,
+* keeping its DataSize points. cap must be at least DataSize.
+* A columnar line moves its Y values to follow the end of the X values.
 ************************************************************************/
-int Fl_PlotXY::scalemode(int line, int mode)
+static int store_resize(Fl_PlotXY_Line *L, unsigned long int cap)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 1)
-        printf("Fl_PlotXY::scalemode(int line, int mode)\n");
-    if ((L = getselected(line)) == NULL)
-        return (0); /* Get Data */
-    L->ScaleMode = mode;
+    Fl_PlotXY_Data *D;
+    char *C;
+    unsigned long int xs, ys;
+
+    if (!L->Columnar)
+    {
+        if ((D = (Fl_PlotXY_Data *)pool_realloc(L->Pool, L->data, sizeof(Fl_PlotXY_Data) * cap)) == NULL)
+            return (0);
+        L->data = D;
+    }
+    else
+    {
+        xs = col_size(L->XCol.Type);
+        ys = col_size(L->YCol.Type);
+
+        /* Smaller - Y values down first, while the block is still big */
+        if (L->Cols != NULL && cap < L->DataCapacity)
+            memmove(L->Cols + cap * xs, L->Cols + L->DataCapacity * xs, ys * L->DataSize);
+
+        if ((C = (char *)pool_realloc(L->Pool, L->Cols, (xs + ys) * cap)) == NULL)
+        {
+            /* Old block is still valid - put the Y values back */
+            if (L->Cols != NULL && cap < L->DataCapacity)
+                memmove(L->Cols + L->DataCapacity * xs, L->Cols + cap * xs, ys * L->DataSize);
+            return (0);
+        }
+
+        /* Bigger - Y values up to the new end of the X values */
+        if (cap > L->DataCapacity)
+            memmove(C + cap * xs, C + L->DataCapacity * xs, ys * L->DataSize);
+        L->Cols = C;
+    }
+
+    L->DataCapacity = cap;
+    line_cols(L);
     return (1);
 }
 
 /************************************************************************
-*                          linemode
-*Sets the line mode
+*                          store_move
+* Move points [first,first+keep) of a line into new storage of cap
+* points in the given layout, oldest first so a ring buffer unwraps.
+* Segmented storage is made of enough chunks for cap points.
+* The values are stored as xtype and ytype, scaled the same as
+* those columns. Uniform X numbering carries on from xtype.
 ************************************************************************/
-int Fl_PlotXY::drawmode(int line, int mode)
+static int store_move(Fl_PlotXY_Line *L, unsigned long int cap, int columnar, int segmented,
+                      unsigned long int first, unsigned long int keep,
+                      const Fl_PlotXY_Column *xtype, const Fl_PlotXY_Column *ytype)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 1)
-        printf("Fl_PlotXY::drawmode(int line , int mode)\n");
-    if ((L = getselected(line)) == NULL)
-        return (0); /* Get Data */
-    L->DrawMode = mode;
+    Fl_PlotXY_Data *D = NULL;
+    Fl_PlotXY_Column X = *xtype, Y = *ytype;
+    char *C = NULL, **T = NULL;
+    unsigned long int count, c, p, chunks = 0;
+
+    if (cap > (unsigned long int)-1 / sizeof(Fl_PlotXY_Data) - FL_PLOTXY_CHUNK)
+        return (0); /* Would overflow */
+
+    if (segmented)
+    {
+        chunks = (cap + FL_PLOTXY_CHUNK - 1) >> FL_PLOTXY_CHUNK_SHIFT;
+        if (chunks > 0 && (T = (char **)malloc(chunks * sizeof(char *))) == NULL)
+            return (0);
+        for (c = 0; c < chunks; c++)
+        {
+            if ((T[c] = (char *)pool_alloc(L->Pool, FL_PLOTXY_CHUNK * (col_size(X.Type) + col_size(Y.Type)))) == NULL)
+            {
+                while (c > 0)
+                    pool_free(L->Pool, T[--c]);
+                free(T);
+                return (0);
+            }
+        }
+        col_chunks(&X, &Y, T, chunks, columnar);
+    }
+    else
+    {
+        if (cap > 0)
+        {
+            if (columnar)
+                C = (char *)pool_alloc(L->Pool, (col_size(X.Type) + col_size(Y.Type)) * cap);
+            else
+                D = (Fl_PlotXY_Data *)pool_alloc(L->Pool, sizeof(Fl_PlotXY_Data) * cap);
+            if (C == NULL && D == NULL)
+                return (0);
+        }
+        col_place(&X, &Y, D, C, cap);
+    }
+
+    for (count = 0; count < keep; count += c)
+    {
+        c = line_run(L, first + count, first + keep, &p);
+        col_move(&X, count, &L->XCol, p, c);
+        col_move(&Y, count, &L->YCol, p, c);
+    }
+
+    pool_free(L->Pool, L->data);
+    pool_free(L->Pool, L->Cols);
+    chunk_free(L);
+    L->data = D;
+    L->Cols = C;
+    L->Chunk = T;
+    L->Chunks = L->ChunkSlots = chunks;
+    L->Columnar = columnar;
+    L->Segmented = segmented;
+    L->XCol = X;
+    L->YCol = Y;
+    L->XCol.Base += first; /* Points before first are dropped */
+    L->DataCapacity = segmented ? chunks << FL_PLOTXY_CHUNK_SHIFT : cap;
+    L->DataStart = 0;
+    line_cols(L);
     return (1);
 }
 
 /************************************************************************
-*                          clear
-*Clear the lines data
+*                          Column kernels
+* Scans work down one column at a time - on a columnar line that is
+* a plain run of doubles.
+* Each kernel has a plain C version and SSE2/AVX2/AVX-512 versions for
+* x86, picked by simd_pick() from what the CPU says it can do.
+* All of them give the same results: min/max keep the first of equal
+* values the same way, pixels use the same add, multiply and truncate.
+* text_count counts one character through a file being loaded.
 ************************************************************************/
-void Fl_PlotXY::clear(int line)
-{
-    Fl_PlotXY_Line *L;
-
-    if (P_DEBUG > 1)
-        printf("Fl_PlotXY::clear(int line)\n");
-    if ((L = getselected(line)) == NULL)
-        return; /* Check for valid line */
-
-    if (P_DEBUG > 1)
-        printf(" Freeing Memory\n");
 
-    /* Free the Memory Used */
-    if (L->data != NULL)
-        free(L->data);
-    // L->data=NULL;
-
-    if (P_DEBUG > 1)
-        printf(" Allocating Memory\n");
+/* Widen [*mn,*mx] to take in n values */
+static void col_minmax_c(const double *V, int step, unsigned long int n, double *mn, double *mx)
+{
+    unsigned long int count;
+    double lo = *mn, hi = *mx;
 
-    /* Allocate one spot of memory */
-    L->data = (Fl_PlotXY_Data *)realloc(NULL, sizeof(Fl_PlotXY_Data));
+    if (step == 1)
+    {
+        for (count = 0; count < n; count++)
+        {
+            lo = V[count] < lo ? V[count] : lo;
+            hi = V[count] > hi ? V[count] : hi;
+        }
+    }
+    else
+    {
+        for (count = 0; count < n; count++, V += step)
+        {
+            lo = *V < lo ? *V : lo;
+            hi = *V > hi ? *V : hi;
+        }
+    }
 
-    L->DataSize = 0; /* Set Data size to 0 */
+    *mn = lo;
+    *mx = hi;
 }
 
-/************************************************************************
-*                          clearall
-* Clear all lines data
-************************************************************************/
-void Fl_PlotXY::clearall(void)
+/* Pixel positions base + dir * (int)((V + shift) * scale) of n values */
+static void col_pixels_c(const double *V, int step, int n, double shift, double scale, int base, int dir, int *out)
 {
     int count;
-    if (P_DEBUG > 1)
-        printf("Fl_PlotXY::clearall(void)\n");
 
-    for (count = 0; count < FL_PLOTXY_MAXLINES; count++)
+    if (step == 1)
     {
-        clear(count);
+        for (count = 0; count < n; count++)
+            out[count] = base + dir * (int)((V[count] + shift) * scale);
+    }
+    else
+    {
+        for (count = 0; count < n; count++, V += step)
+            out[count] = base + dir * (int)((*V + shift) * scale);
     }
 }
 
-/************************************************************************
-*                          remove
-* Remove individual line
-************************************************************************/
-void Fl_PlotXY::remove(int line)
+/* How many of n bytes from s are c */
+static unsigned long int text_count_c(const char *s, unsigned long int n, char c)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 1)
-        printf("Fl_PlotXY::remove(int line)\n");
-    if ((L = getselected(line)) == NULL)
-        return; /* Check for valid line */
+    unsigned long int count, found = 0;
 
-    /* Free any memory used */
-    clear(line);
+    for (count = 0; count < n; count++)
+        found += s[count] == c;
+    return (found);
+}
 
-    /* Indicate Not used any more */
-    L->LineNumber = -1;
-    L->DataSize = 0;              /* Set Data size to 0        */
-    L->Displayed = 0;             /* Turn Line Display OFF     */
-    L->DrawMode = FL_PLOTXY_LINE; /* Line Drawing Mode         */
-    L->ScaleMode = FL_PLOTXY_AUTO;
-    L->Xmin = 0.0;
-    L->Xmax = 0.0;
-    L->Ymin = 0.0;
-    L->Ymax = 0.0;
-    L->title = NULL; /* Pointer to string array for title */
-    L->C = FL_BLACK; /* Line and title Colour             */
+#if !defined(FL_PLOTXY_NO_SIMD) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#define FL_PLOTXY_X86 1
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define FL_PLOTXY_TARGET(t)
+#else
+#define FL_PLOTXY_TARGET(t) __attribute__((target(t)))
+#endif
+
+/* Fold the lanes of a vector min/max into [*mn,*mx] */
+static void lanes_minmax(const double *lo, const double *hi, int lanes, double *mn, double *mx)
+{
+    col_minmax_c(lo, 1, lanes, mn, mx);
+    col_minmax_c(hi, 1, lanes, mn, mx);
 }
 
-/************************************************************************
-*                          removeall
-* Remove All Lines
-************************************************************************/
-void Fl_PlotXY::removeall(void)
+/* SSE2 - 2 values at a time */
+FL_PLOTXY_TARGET("sse2")
+static void col_minmax_sse2(const double *V, int step, unsigned long int n, double *mn, double *mx)
 {
-    int count;
-    if (P_DEBUG > 1)
-        printf("Fl_PlotXY::removeall(void)\n");
-    for (count = 0; count < FL_PLOTXY_MAXLINES; count++)
+    __m128d lo = _mm_set1_pd(*mn), hi = _mm_set1_pd(*mx), v;
+    double l[2], h[2];
+    unsigned long int count = 0;
+
+    if (step == 1)
     {
-        remove(count);
+        for (; count + 2 <= n; count += 2)
+        {
+            v = _mm_loadu_pd(V + count);
+            lo = _mm_min_pd(v, lo);
+            hi = _mm_max_pd(v, hi);
+        }
+    }
+    else if (step == 2)
+    {
+        /* Interleaved - the other column is loaded and thrown away */
+        for (; count + 2 < n; count += 2)
+        {
+            v = _mm_unpacklo_pd(_mm_loadu_pd(V + 2 * count), _mm_loadu_pd(V + 2 * count + 2));
+            lo = _mm_min_pd(v, lo);
+            hi = _mm_max_pd(v, hi);
+        }
     }
+
+    _mm_storeu_pd(l, lo);
+    _mm_storeu_pd(h, hi);
+    lanes_minmax(l, h, 2, mn, mx);
+    col_minmax_c(V + count * step, step, n - count, mn, mx);
 }
 
-/************************************************************************
-*                          change
-* Change value of a point
-************************************************************************/
-int Fl_PlotXY::change(int line, unsigned long int p, double X, double Y)
+FL_PLOTXY_TARGET("sse2")
+static void col_pixels_sse2(const double *V, int step, int n, double shift, double scale, int base, int dir, int *out)
 {
-    Fl_PlotXY_Line *L;
-    Fl_PlotXY_Data *D;
+    __m128d s = _mm_set1_pd(shift), k = _mm_set1_pd(scale), v;
+    __m128i b = _mm_set1_epi32(base), t;
+    int count = 0;
 
-    if (P_DEBUG > 1)
-        printf("Fl_PlotXY::change(int,unsigned long int,double,double)\n");
+    if (step == 1 || step == 2)
+    {
+        for (; count + 2 < n; count += 2)
+        {
+            if (step == 1)
+                v = _mm_loadu_pd(V + count);
+            else
+                v = _mm_unpacklo_pd(_mm_loadu_pd(V + 2 * count), _mm_loadu_pd(V + 2 * count + 2));
+            t = _mm_cvttpd_epi32(_mm_mul_pd(_mm_add_pd(v, s), k));
+            t = dir > 0 ? _mm_add_epi32(b, t) : _mm_sub_epi32(b, t);
+            _mm_storel_epi64((__m128i *)(out + count), t);
+        }
+    }
 
-    /* Get Data */
-    if ((L = getselected(line)) == NULL)
-        return 0; /* Data Set not avaliable */
+    col_pixels_c(V + count * step, step, n - count, shift, scale, base, dir, out + count);
+}
 
-    /* Check  if change is in range */
-    if (p >= L->DataSize)
-        return 0; /* Out of range */
+/* SSE2 - 16 bytes at a time. Each byte lane counts up to 255 matches,
+ * then the lanes are added up. */
+FL_PLOTXY_TARGET("sse2")
+static unsigned long int text_count_sse2(const char *s, unsigned long int n, char c)
+{
+    __m128i k = _mm_set1_epi8(c), z = _mm_setzero_si128(), acc, sum = _mm_setzero_si128();
+    unsigned long int count = 0, round;
+    unsigned long long lanes[2];
 
-    if (P_DEBUG > 1)
-        printf(" Changing Data\n");
+    while (n - count >= 16)
+    {
+        acc = z;
+        for (round = 0; round < 255 && n - count >= 16; round++, count += 16)
+            acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(s + count)), k));
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(acc, z));
+    }
 
-    D = L->data;
+    _mm_storeu_si128((__m128i *)lanes, sum);
+    return ((unsigned long int)(lanes[0] + lanes[1]) + text_count_c(s + count, n - count, c));
+}
 
-    /* Change the Data */
-    while (p > 0)
+/* AVX2 - 4 values at a time */
+FL_PLOTXY_TARGET("avx2")
+static void col_minmax_avx2(const double *V, int step, unsigned long int n, double *mn, double *mx)
+{
+    __m256d lo = _mm256_set1_pd(*mn), hi = _mm256_set1_pd(*mx), v;
+    double l[4], h[4];
+    unsigned long int count = 0;
+
+    if (step == 1)
     {
-        D++, p--;
+        for (; count + 4 <= n; count += 4)
+        {
+            v = _mm256_loadu_pd(V + count);
+            lo = _mm256_min_pd(v, lo);
+            hi = _mm256_max_pd(v, hi);
+        }
+    }
+    else if (step == 2)
+    {
+        /* Comes out of order, which does not matter for min/max */
+        for (; count + 4 < n; count += 4)
+        {
+            v = _mm256_unpacklo_pd(_mm256_loadu_pd(V + 2 * count), _mm256_loadu_pd(V + 2 * count + 4));
+            lo = _mm256_min_pd(v, lo);
+            hi = _mm256_max_pd(v, hi);
+        }
     }
 
-    D->X = X;
-    D->Y = Y;
-
-    if (P_DEBUG > 1)
-        printf(" Done\n");
-    return (1);
+    _mm256_storeu_pd(l, lo);
+    _mm256_storeu_pd(h, hi);
+    lanes_minmax(l, h, 4, mn, mx);
+    col_minmax_c(V + count * step, step, n - count, mn, mx);
 }
 
-/************************************************************************
-*                          read
-* Read value of a point
-************************************************************************/
-int Fl_PlotXY::read(int line, unsigned long int p, double *X, double *Y)
+FL_PLOTXY_TARGET("avx2")
+static void col_pixels_avx2(const double *V, int step, int n, double shift, double scale, int base, int dir, int *out)
 {
-    Fl_PlotXY_Line *L;
-    Fl_PlotXY_Data *D;
+    __m256d s = _mm256_set1_pd(shift), k = _mm256_set1_pd(scale), v;
+    __m128i b = _mm_set1_epi32(base), t;
+    int count = 0;
 
-    *X = 0.0;
-    *Y = 0.0;
+    if (step == 1 || step == 2)
+    {
+        for (; count + 4 < n; count += 4)
+        {
+            if (step == 1)
+                v = _mm256_loadu_pd(V + count);
+            else
+                v = _mm256_permute4x64_pd(_mm256_unpacklo_pd(_mm256_loadu_pd(V + 2 * count),
+                                                             _mm256_loadu_pd(V + 2 * count + 4)),
+                                          _MM_SHUFFLE(3, 1, 2, 0));
+            t = _mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_add_pd(v, s), k));
+            t = dir > 0 ? _mm_add_epi32(b, t) : _mm_sub_epi32(b, t);
+            _mm_storeu_si128((__m128i *)(out + count), t);
+        }
+    }
 
-    if (P_DEBUG > 1)
-        printf("Fl_PlotXY::read(int,unsigned long int,double*,double*)\n");
+    col_pixels_c(V + count * step, step, n - count, shift, scale, base, dir, out + count);
+}
 
-    /* Get Data */
-    if ((L = getselected(line)) == NULL)
-        return 0; /* Data Set not avaliable */
+/* AVX2 - 32 bytes at a time, AVX-512F has no byte compare so uses this too */
+FL_PLOTXY_TARGET("avx2")
+static unsigned long int text_count_avx2(const char *s, unsigned long int n, char c)
+{
+    __m256i k = _mm256_set1_epi8(c), z = _mm256_setzero_si256(), acc, sum = _mm256_setzero_si256();
+    unsigned long int count = 0, round;
+    unsigned long long lanes[4];
 
-    /* Check  if change is in range */
-    if (p >= L->DataSize)
-        return 0; /* Out of range */
+    while (n - count >= 32)
+    {
+        acc = z;
+        for (round = 0; round < 255 && n - count >= 32; round++, count += 32)
+            acc = _mm256_sub_epi8(acc, _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(s + count)), k));
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(acc, z));
+    }
 
-    if (P_DEBUG > 1)
-        printf(" Reading Data\n");
+    _mm256_storeu_si256((__m256i *)lanes, sum);
+    return ((unsigned long int)(lanes[0] + lanes[1] + lanes[2] + lanes[3]) + text_count_c(s + count, n - count, c));
+}
 
-    D = L->data;
+/* AVX-512 - 8 values at a time, interleaved columns go to AVX2.
+ * The all-lanes masked forms give GCC a defined pass-through register,
+ * the plain ones leave it undefined and warn. */
+FL_PLOTXY_TARGET("avx512f")
+static void col_minmax_avx512(const double *V, int step, unsigned long int n, double *mn, double *mx)
+{
+    __m512d lo = _mm512_set1_pd(*mn), hi = _mm512_set1_pd(*mx), v;
+    double l[8], h[8];
+    unsigned long int count = 0;
 
-    /* Change the Data */
-    while (p > 0)
+    if (step != 1)
     {
-        D++, p--;
+        col_minmax_avx2(V, step, n, mn, mx);
+        return;
     }
 
-    *X = D->X;
-    *Y = D->Y;
+    for (; count + 8 <= n; count += 8)
+    {
+        v = _mm512_loadu_pd(V + count);
+        lo = _mm512_mask_min_pd(lo, 0xFF, v, lo);
+        hi = _mm512_mask_max_pd(hi, 0xFF, v, hi);
+    }
 
-    return (1);
+    _mm512_storeu_pd(l, lo);
+    _mm512_storeu_pd(h, hi);
+    lanes_minmax(l, h, 8, mn, mx);
+    col_minmax_c(V + count, 1, n - count, mn, mx);
 }
 
-/************************************************************************
-*                          datasize
-*Return current Data position
-************************************************************************/
-unsigned long int Fl_PlotXY::datasize(int line)
+FL_PLOTXY_TARGET("avx512f")
+static void col_pixels_avx512(const double *V, int step, int n, double shift, double scale, int base, int dir, int *out)
 {
-    Fl_PlotXY_Line *L;
+    __m512d s = _mm512_set1_pd(shift), k = _mm512_set1_pd(scale);
+    __m256i b = _mm256_set1_epi32(base), t;
+    int count = 0;
 
-    if (P_DEBUG > 1)
-        printf("Fl_PlotXY::datasize(int)\n");
-
-    /* Get Data */
-    if ((L = getselected(line)) == NULL)
-        return (0); /* Data Set not avaliable */
+    if (step != 1)
+    {
+        col_pixels_avx2(V, step, n, shift, scale, base, dir, out);
+        return;
+    }
 
-    if (P_DEBUG > 1)
-        printf(" DataSize=%ld\n", L->DataSize);
+    for (; count + 8 <= n; count += 8)
+    {
+        t = _mm512_maskz_cvttpd_epi32(0xFF, _mm512_mul_pd(_mm512_add_pd(_mm512_loadu_pd(V + count), s), k));
+        t = dir > 0 ? _mm256_add_epi32(b, t) : _mm256_sub_epi32(b, t);
+        _mm256_storeu_si256((__m256i *)(out + count), t);
+    }
 
-    return (L->DataSize);
+    col_pixels_c(V + count, 1, n - count, shift, scale, base, dir, out + count);
 }
 
-/************************************************************************
-*                          used
-* Indicates if line number is in use
-************************************************************************/
-int Fl_PlotXY::used(int line)
+/* Best kernel set the CPU (and OS) can run */
+static int simd_detect(void)
 {
-    Fl_PlotXY_Line *L;
-
-    if (P_DEBUG > 1)
-        printf("Fl_PlotXY::used(int)\n");
-    /* Get Data */
-    if ((L = getselected(line)) == NULL)
-        return (0); /* Data Set not avaliable */
-    return (1);
+#if defined(_MSC_VER)
+    int r[4], max;
+    unsigned long long xcr0 = 0;
+
+    __cpuid(r, 0);
+    max = r[0];
+    __cpuid(r, 1);
+    if (!(r[3] & (1 << 26)))
+        return (FL_PLOTXY_SIMD_NONE);
+    if (!(r[2] & (1 << 27)) || max < 7)
+        return (FL_PLOTXY_SIMD_SSE2); /* No OSXSAVE - no AVX state */
+
+    xcr0 = _xgetbv(0);
+    __cpuidex(r, 7, 0);
+    if ((xcr0 & 0xE6) == 0xE6 && (r[1] & (1 << 16)))
+        return (FL_PLOTXY_SIMD_AVX512);
+    if ((xcr0 & 0x06) == 0x06 && (r[1] & (1 << 5)))
+        return (FL_PLOTXY_SIMD_AVX2);
+    return (FL_PLOTXY_SIMD_SSE2);
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return (FL_PLOTXY_SIMD_AVX512);
+    if (__builtin_cpu_supports("avx2"))
+        return (FL_PLOTXY_SIMD_AVX2);
+    if (__builtin_cpu_supports("sse2"))
+        return (FL_PLOTXY_SIMD_SSE2);
+    return (FL_PLOTXY_SIMD_NONE);
+#endif
 }
+#endif
 
-/************************************************************************
-*                          lineshow
-*Turn a line on
-************************************************************************/
-int Fl_PlotXY::lineshow(int line)
+/* Kernels in use, set by simd_pick - the first plot made picks them,
+ * before any thread can use them, and they stay while a job runs */
+static void (*col_minmax_k)(const double *, int, unsigned long int, double *, double *) = col_minmax_c;
+static void (*col_pixels_k)(const double *, int, int, double, double, int, int, int *) = col_pixels_c;
+static unsigned long int (*text_count_k)(const char *, unsigned long int, char) = text_count_c;
+static int SimdLevel = -1; /* Kernel set in use, -1 = not picked yet */
+static int SimdJobs = 0;   /* Background jobs of all plots, kept by job_new and job_free */
+
+/* Use the best kernels up to level */
+static int simd_pick(int level)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 1)
-        printf("Fl_PlotXY::lineshow(int)\n");
-    /* Get Data */
-    if ((L = getselected(line)) == NULL)
-        return (0); /* Data Set not avaliable */
+    col_minmax_k = col_minmax_c;
+    col_pixels_k = col_pixels_c;
+    text_count_k = text_count_c;
+    SimdLevel = FL_PLOTXY_SIMD_NONE;
 
-    L->Displayed = 1;
+#ifdef FL_PLOTXY_X86
+    {
+        int cpu = simd_detect();
 
-    return (1);
+        if (level > cpu)
+            level = cpu;
+
+        if (level >= FL_PLOTXY_SIMD_AVX512)
+        {
+            col_minmax_k = col_minmax_avx512;
+            col_pixels_k = col_pixels_avx512;
+            text_count_k = text_count_avx2;
+            SimdLevel = FL_PLOTXY_SIMD_AVX512;
+        }
+        else if (level == FL_PLOTXY_SIMD_AVX2)
+        {
+            col_minmax_k = col_minmax_avx2;
+            col_pixels_k = col_pixels_avx2;
+            text_count_k = text_count_avx2;
+            SimdLevel = FL_PLOTXY_SIMD_AVX2;
+        }
+        else if (level == FL_PLOTXY_SIMD_SSE2)
+        {
+            col_minmax_k = col_minmax_sse2;
+            col_pixels_k = col_pixels_sse2;
+            text_count_k = text_count_sse2;
+            SimdLevel = FL_PLOTXY_SIMD_SSE2;
+        }
+    }
+#else
+    (void)level;
+#endif
+
+    if (P_DEBUG > 0)
+        printf(" SIMD kernels: %d\n", SimdLevel);
+    return (SimdLevel);
 }
 
-/************************************************************************
-*                          linehide
-* turn Line off
-************************************************************************/
-int Fl_PlotXY::linehide(int line)
+static inline void col_minmax(const double *V, int step, unsigned long int n, double *mn, double *mx)
 {
-    Fl_PlotXY_Line *L;
-
-    if (P_DEBUG > 1)
-        printf("Fl_PlotXY::linehide(int)\n");
-    /* Get Data */
-    if ((L = getselected(line)) == NULL)
-        return (0); /* Data Set not avaliable */
+    col_minmax_k(V, step, n, mn, mx);
+}
 
-    L->Displayed = 0;
+static inline void col_pixels(const double *V, int step, int n, double shift, double scale, int base, int dir, int *out)
+{
+    col_pixels_k(V, step, n, shift, scale, base, dir, out);
+}
 
-    return (1);
+static inline unsigned long int text_count(const char *s, unsigned long int n, char c)
+{
+    return (text_count_k(s, n, c));
 }
 
-/************************************************************************
-*                          linevisible
-*Check if line is currently visible
-************************************************************************/
-int Fl_PlotXY::linevisible(int line)
+/* Widen [*mn,*mx] to take in n values of a column from position p,
+ * all in one chunk of a segmented line.
+ * Integer and float columns are scanned as stored - converting is
+ * in order, so the ends of the raw range are the ends of the values. */
+static void col_scan(const Fl_PlotXY_Column *C, unsigned long int p, unsigned long int n, double *mn, double *mx)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 1)
-        printf("Fl_PlotXY::linevisible(int)\n");
-    /* Get Data */
-    if ((L = getselected(line)) == NULL)
-        return (-1); /* Data Set not avaliable */
+    unsigned long int count;
+    double lo, hi, t;
+    int ilo, ihi;
+    float flo, fhi;
 
-    return (L->Displayed);
+    if (n == 0)
+        return;
+
+    switch (C->Type)
+    {
+    case FL_PLOTXY_FLOAT:
+    {
+        const float *V = (const float *)col_at(C, p);
+        flo = fhi = V[0];
+        for (count = 1; count < n; count++)
+        {
+            flo = V[count] < flo ? V[count] : flo;
+            fhi = V[count] > fhi ? V[count] : fhi;
+        }
+        lo = flo;
+        hi = fhi;
+        break;
+    }
+
+    case FL_PLOTXY_INT16:
+    {
+        const short *V = (const short *)col_at(C, p);
+        ilo = ihi = V[0];
+        for (count = 1; count < n; count++)
+        {
+            ilo = V[count] < ilo ? V[count] : ilo;
+            ihi = V[count] > ihi ? V[count] : ihi;
+        }
+        lo = ilo * C->Gain + C->Offset;
+        hi = ihi * C->Gain + C->Offset;
+        break;
+    }
+
+    case FL_PLOTXY_INT32:
+    {
+        const int *V = (const int *)col_at(C, p);
+        ilo = ihi = V[0];
+        for (count = 1; count < n; count++)
+        {
+            ilo = V[count] < ilo ? V[count] : ilo;
+            ihi = V[count] > ihi ? V[count] : ihi;
+        }
+        lo = ilo * C->Gain + C->Offset;
+        hi = ihi * C->Gain + C->Offset;
+        break;
+    }
+
+    case FL_PLOTXY_UNIFORM:
+        /* Goes one way, so just the ends */
+        lo = col_get(C, p);
+        hi = col_get(C, p + n - 1);
+        break;
+
+    default:
+        col_minmax((const double *)col_at(C, p), C->Stride / sizeof(double), n, mn, mx);
+        return;
+    }
+
+    /* A negative gain turns the range over */
+    if (lo > hi)
+    {
+        t = lo;
+        lo = hi;
+        hi = t;
+    }
+    *mn = lo < *mn ? lo : *mn;
+    *mx = hi > *mx ? hi : *mx;
 }
 
-/************************************************************************
-*                          xmarkon(int)
-* check if X marks are On or Off
-************************************************************************/
-int Fl_PlotXY::xmarkon(int line)
+/* Pixel positions of n values of a column from position p, all in one
+ * chunk - other than doubles are converted a block at a time first */
+static void col_topixels(const Fl_PlotXY_Column *C, unsigned long int p, int n, double shift, double scale, int base, int dir, int *out)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 2)
-        printf("Fl_PlotXY::xmarkon(int)\n");
-    /* Get Data */
-    if ((L = getselected(line)) == NULL)
-        return (-1); /* Data Set not avaliable */
+    double V[FL_PLOTXY_VERTICES];
+    int count;
 
-    return (L->XMark);
+    if (C->Type == FL_PLOTXY_DOUBLE)
+    {
+        col_pixels((const double *)col_at(C, p), C->Stride / sizeof(double), n, shift, scale, base, dir, out);
+        return;
+    }
+
+    for (count = 0; count < n; count++)
+        V[count] = col_get(C, p + count);
+    col_pixels(V, 1, n, shift, scale, base, dir, out);
 }
 
-/************************************************************************
-*                            xmarkon(int,int)
-*Turn X marks on or Off
-************************************************************************/
-int Fl_PlotXY::xmarkon(int line, int mode)
+/* X pixels of n rows of a line's group from row p. Whole blocks of rows
+ * are worked out once and kept for the other lines of the group, for
+ * as long as they are drawn with the same scale. */
+static void group_pixels(const Fl_PlotXY_Line *L, unsigned long int p, int n, int left, int *xs)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 2)
-        printf("Fl_PlotXY::xmarkon(int,int)\n");
-    /* Get Data */
-    if ((L = getselected(line)) == NULL)
-        return (0); /* Data Set not avaliable */
+    Fl_PlotXY_Group *G = L->Group;
+    unsigned long int b, c, cap, whole;
+    unsigned char *dp;
+    int *xp;
 
-    L->XMark = mode;
+    /* Room for every row, or work them out each time */
+    if (G->XPixCapacity < G->Capacity)
+    {
+        cap = G->Capacity;
+        if ((xp = (int *)realloc(G->XPix, cap * sizeof(int))) != NULL)
+            G->XPix = xp;
+        if ((dp = (unsigned char *)realloc(G->XPixDone, (cap >> FL_PLOTXY_GROUP_SHIFT) + 1)) != NULL)
+            G->XPixDone = dp;
+        if (xp == NULL || dp == NULL)
+        {
+            col_pixels(G->X + p, 1, n, L->X_Left, L->X_Scale, left, 1, xs);
+            return;
+        }
+        b = G->XPixCapacity >> FL_PLOTXY_GROUP_SHIFT;
+        memset(G->XPixDone + b, 0, (cap >> FL_PLOTXY_GROUP_SHIFT) + 1 - b);
+        G->XPixCapacity = cap;
+    }
 
-    return (1);
+    /* A different scale - work them out again */
+    if (G->XPixLeft != L->X_Left || G->XPixScale != L->X_Scale || G->XPixBase != left)
+    {
+        memset(G->XPixDone, 0, (G->XPixCapacity >> FL_PLOTXY_GROUP_SHIFT) + 1);
+        G->XPixLeft = L->X_Left;
+        G->XPixScale = L->X_Scale;
+        G->XPixBase = left;
+    }
+
+    /* Whole blocks the rows are in - the last one may still be filling */
+    whole = G->Size >> FL_PLOTXY_GROUP_SHIFT;
+    for (b = p >> FL_PLOTXY_GROUP_SHIFT; b < whole && (b << FL_PLOTXY_GROUP_SHIFT) < p + n; b++)
+    {
+        if (!G->XPixDone[b])
+        {
+            col_pixels(G->X + (b << FL_PLOTXY_GROUP_SHIFT), 1, 1 << FL_PLOTXY_GROUP_SHIFT,
+                       L->X_Left, L->X_Scale, left, 1, G->XPix + (b << FL_PLOTXY_GROUP_SHIFT));
+            G->XPixDone[b] = 1;
+        }
+    }
+
+    /* Copy those, the rest are worked out */
+    whole <<= FL_PLOTXY_GROUP_SHIFT;
+    c = p >= whole ? 0 : p + n <= whole ? n : whole - p;
+    memcpy(xs, G->XPix + p, c * sizeof(int));
+    if (c < (unsigned long int)n)
+        col_pixels(G->X + p + c, 1, n - (int)c, L->X_Left, L->X_Scale, left, 1, xs + c);
 }
 
-/************************************************************************
-*                          xmarkstep(int,double)
-* Set the X mark step size
-************************************************************************/
-int Fl_PlotXY::xmarkstep(int line, double size)
+/* Pixel positions of points from `first' (before `last') on a plot with
+ * its left edge at left and bottom edge at bottom, using the line's scale.
+ * Does as many as lie together in storage, up to FL_PLOTXY_VERTICES,
+ * and returns how many. */
+static int line_pixels(const Fl_PlotXY_Line *L, unsigned long int first, unsigned long int last,
+                       int left, int bottom, int *xs, int *ys)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 2)
-        printf("Fl_PlotXY::xmarkstep(int,double)\n");
-    /* Get Data */
-    if ((L = getselected(line)) == NULL)
-        return (0); /* Data Set not avaliable */
+    unsigned long int p, n;
 
-    L->XMarkSize = size;
+    n = line_run(L, first, last, &p);
+    if (n > FL_PLOTXY_VERTICES)
+        n = FL_PLOTXY_VERTICES;
 
-    return (1);
+    if (L->Group != NULL)
+        group_pixels(L, p, (int)n, left, xs);
+    else
+        col_topixels(&L->XCol, p, (int)n, L->X_Left, L->X_Scale, left, 1, xs);
+    col_topixels(&L->YCol, p, (int)n, L->Y_Bottom, L->Y_Scale, bottom, -1, ys);
+    return ((int)n);
 }
 
-/************************************************************************
-*                          xmarklabel(int,const char*)
-* Set the X Axis Label
-************************************************************************/
-int Fl_PlotXY::xmarklabel(int line, const char *xlabel)
+/* Narrow points [*first,*last) of a uniform X line to those on a w pixel
+ * wide plot, keeping two either side to join on to. Works from the
+ * sample numbers alone, no point is read. */
+static void line_visible(const Fl_PlotXY_Line *L, int w, unsigned long int *first, unsigned long int *last)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 2)
-        printf("Fl_PlotXY::xmarklabel(int,const char*)\n");
-    /* Get Data */
-    if ((L = getselected(line)) == NULL)
-        return (0); /* Data Set not avaliable */
+    const Fl_PlotXY_Column *C = &L->XCol;
+    double lo, hi, t;
 
-    L->XLabel = xlabel;
+    if (C->Type != FL_PLOTXY_UNIFORM || *first >= *last)
+        return;
 
-    return (1);
+    /* Points at the left and right edges, a pixel out as pixels truncate */
+    lo = (-L->X_Left - 1.0 / L->X_Scale - C->Offset) / C->Gain - C->Base;
+    hi = (-L->X_Left + (w + 1) / L->X_Scale - C->Offset) / C->Gain - C->Base;
+    if (lo > hi)
+    {
+        t = lo;
+        lo = hi;
+        hi = t;
+    }
+    if (lo != lo || hi != hi)
+        return;
+    lo = floor(lo) - 2.0;
+    hi = ceil(hi) + 3.0;
+
+    if (lo > (double)*first)
+        *first = lo >= (double)*last ? *last : (unsigned long int)lo;
+    if (hi < (double)*last)
+        *last = hi <= (double)*first ? *first : (unsigned long int)hi;
 }
 
-/************************************************************************
-*                          const char* xmarklabel(int)
-*Return the X Axis Label
-************************************************************************/
-const char *Fl_PlotXY::xmarklabel(int line)
+/* Y range of points [first,last), around a ring buffer */
+static void line_yrange(const Fl_PlotXY_Line *L, unsigned long int first, unsigned long int last, double *mn, double *mx)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 2)
-        printf("Fl_PlotXY::xmarklabel(int,const char*)\n");
-    /* Get Data */
-    if ((L = getselected(line)) == NULL)
-        return NULL; /* Data Set not avaliable */
+    unsigned long int p, n;
 
-    return (L->XLabel);
+    for (; first < last; first += n)
+    {
+        n = line_run(L, first, last, &p);
+        col_scan(&L->YCol, p, n, mn, mx);
+    }
 }
 
 /************************************************************************
-*                     xvaltype(int,int)
-* Set the X value type (time, date etc)
+*                          bounds_add
+* Widen the line's data range to take in a new point.
+* Must be called before DataSize counts the point.
 ************************************************************************/
-int Fl_PlotXY::xvaltype(int line, int type)
+static inline void bounds_add(Fl_PlotXY_Line *L, double X, double Y)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 2)
-        printf("Fl_PlotXY::xvaltype(int,int)\n");
-    if ((L = getselected(line)) == NULL)
-        return (0); /* Data Set not avaliable */
+    if (!L->BoundsValid)
+    {
+        /* Out of date ranges get rebuilt by minmax - only start afresh when empty */
+        if (L->DataSize != 0)
+            return;
 
-    L->XValType = type;
+        L->DataXmin = L->DataXmax = X;
+        L->DataYmin = L->DataYmax = Y;
+        L->BoundsValid = 1;
+        return;
+    }
 
-    return (1);
+    if (X < L->DataXmin)
+        L->DataXmin = X;
+    if (X > L->DataXmax)
+        L->DataXmax = X;
+    if (Y < L->DataYmin)
+        L->DataYmin = Y;
+    if (Y > L->DataYmax)
+        L->DataYmax = Y;
 }
 
 /************************************************************************
-*                     xvaltype(int,int)
-* return X value type (time, date etc)
+*                          bounds_drop
+* A point is about to go - if it is on the edge of the data range
+* the range has to be found again.
 ************************************************************************/
-int Fl_PlotXY::xvaltype(int line)
+static inline void bounds_drop(Fl_PlotXY_Line *L, double X, double Y)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 2)
-        printf("Fl_PlotXY::xvaltype(int,int)\n");
-    if ((L = getselected(line)) == NULL)
-        return (-1); /* Data Set not avaliable */
-
-    return (L->XValType);
+    if (L->BoundsValid &&
+        (X == L->DataXmin || X == L->DataXmax || Y == L->DataYmin || Y == L->DataYmax))
+        L->BoundsValid = 0;
 }
 
 /************************************************************************
-*                          ymarkon(int)
-*check if Y marks are On or Off
+*                          block_add
+* Widen a pyramid block to take in a point
 ************************************************************************/
-int Fl_PlotXY::ymarkon(int line)
+static inline void block_add(Fl_PlotXY_Block *B, double X, double Y)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 2)
-        printf("Fl_PlotXY::ymarkon(int)\n");
-    /* Get Data */
-    if ((L = getselected(line)) == NULL)
-        return (-1); /* Data Set not avaliable */
-
-    return (L->YMark);
+    if (X < B->Xmin)
+        B->Xmin = X;
+    if (X > B->Xmax)
+        B->Xmax = X;
+    if (Y < B->Ymin)
+        B->Ymin = Y;
+    if (Y > B->Ymax)
+        B->Ymax = Y;
 }
 
 /************************************************************************
-*                          ymarkon(int,int)
-*Turn Y marks on or Off
+*                          pyramid_free
 ************************************************************************/
-int Fl_PlotXY::ymarkon(int line, int mode)
+static void pyramid_free(Fl_PlotXY_Line *L)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 2)
-        printf("Fl_PlotXY::ymarkon(int,int)\n");
-    /* Get Data */
-    if ((L = getselected(line)) == NULL)
-        return (0); /* Data Set not avaliable */
+    int level;
 
-    L->YMark = mode;
+    if (L->Pyramid == NULL)
+        return;
 
-    return (1);
+    for (level = 0; level < FL_PLOTXY_PYRAMID_LEVELS && !L->Pyramid->Mapped; level++)
+        free(L->Pyramid->Level[level]);
+    free(L->Pyramid);
+    L->Pyramid = NULL;
 }
 
 /************************************************************************
-*                     ymarkstep(int,double)
-* Set the Y mark step size
+*                          pyramid_own
+* Copy levels that are in a loaded file so they can change.
+* If memory runs out the pyramid is dropped and 0 returned.
 ************************************************************************/
-int Fl_PlotXY::ymarkstep(int line, double size)
+static int pyramid_own(Fl_PlotXY_Line *L)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 2)
-        printf("Fl_PlotXY::ymarkstep(int,double)\n");
-    if ((L = getselected(line)) == NULL)
-        return (0); /* Data Set not avaliable */
+    Fl_PlotXY_Pyramid *P = L->Pyramid;
+    Fl_PlotXY_Block *B;
+    int level;
 
-    L->YMarkSize = size;
+    if (!P->Mapped)
+        return (1);
 
+    for (level = 0; level < FL_PLOTXY_PYRAMID_LEVELS; level++)
+    {
+        B = NULL;
+        if (P->Size[level] != 0 && (B = (Fl_PlotXY_Block *)malloc(sizeof(Fl_PlotXY_Block) * P->Size[level])) == NULL)
+        {
+            /* Free the copies so far, not the file */
+            for (; level < FL_PLOTXY_PYRAMID_LEVELS; level++)
+                P->Level[level] = NULL;
+            P->Mapped = 0;
+            pyramid_free(L);
+            return (0);
+        }
+        if (B != NULL)
+            memcpy(B, P->Level[level], sizeof(Fl_PlotXY_Block) * P->Size[level]);
+        P->Level[level] = B;
+        P->Capacity[level] = P->Size[level];
+    }
+
+    P->Mapped = 0;
     return (1);
 }
 
 /************************************************************************
-*                          ymarklabel(int,const char*)
-*Set the Y Axis Label
+*                          pyramid_add
+* Take points [first,DataSize) into the pyramid.
+* Each point only widens the last block on every level.
+* If memory runs out the pyramid is dropped - drawing then reads
+* the points themselves.
 ************************************************************************/
-int Fl_PlotXY::ymarklabel(int line, const char *ylabel)
+static void pyramid_add(Fl_PlotXY_Line *L, unsigned long int first)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 2)
-        printf("Fl_PlotXY::ymarklabel(int,const char*)\n");
-    /* Get Data */
-    if ((L = getselected(line)) == NULL)
-        return (0); /* Data Set not avaliable */
+    Fl_PlotXY_Pyramid *P = L->Pyramid;
+    Fl_PlotXY_Block *B;
+    double X, Y;
+    unsigned long int p, b, cap;
+    int level;
 
-    L->YLabel = ylabel;
-
-    return (1);
-}
+    if (P == NULL || (first < L->DataSize && !pyramid_own(L)))
+        return;
 
-/************************************************************************
-*                    const char* ymarklabel(int)
-*Return the X Axis Label
-************************************************************************/
-const char *Fl_PlotXY::ymarklabel(int line)
-{
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 2)
-        printf("Fl_PlotXY::xmarklabel(int,const char*)\n");
-    /* Get Data */
-    if ((L = getselected(line)) == NULL)
-        return NULL; /* Data Set not avaliable */
+    for (p = first; p < L->DataSize; p++)
+    {
+        X = col_x(L, line_phys(L, p));
+        Y = col_y(L, line_phys(L, p));
+        for (level = 0; level < FL_PLOTXY_PYRAMID_LEVELS; level++)
+        {
+            b = p >> (FL_PLOTXY_PYRAMID_SHIFT * (level + 1));
+            if (b < P->Size[level])
+            {
+                block_add(&P->Level[level][b], X, Y);
+                continue;
+            }
 
-    return (L->YLabel);
+            /* Start a new block */
+            if (b >= P->Capacity[level])
+            {
+                cap = P->Capacity[level] ? P->Capacity[level] * 2 : 16;
+                B = (Fl_PlotXY_Block *)realloc(P->Level[level], sizeof(Fl_PlotXY_Block) * cap);
+                if (B == NULL)
+                {
+                    if (P_DEBUG > 0)
+                        printf(" ERROR: Not Enough Space - pyramid dropped\n");
+                    pyramid_free(L);
+                    return;
+                }
+                P->Level[level] = B;
+                P->Capacity[level] = cap;
+            }
+            B = &P->Level[level][b];
+            B->Xmin = B->Xmax = X;
+            B->Ymin = B->Ymax = Y;
+            P->Size[level] = b + 1;
+        }
+    }
 }
 
 /************************************************************************
-*                     yvaltype(int,int)
-* Set the Y value type (time, date etc)
+*                          pyramid_fix
+* Point p has changed - work out its blocks again from the level below
 ************************************************************************/
-int Fl_PlotXY::yvaltype(int line, int type)
+static void pyramid_fix(Fl_PlotXY_Line *L, unsigned long int p)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 2)
-        printf("Fl_PlotXY::yvaltype(int,int)\n");
-    if ((L = getselected(line)) == NULL)
-        return (0); /* Data Set not avaliable */
+    Fl_PlotXY_Pyramid *P = L->Pyramid;
+    Fl_PlotXY_Block *B, *S;
+    unsigned long int b, first, last;
+    int level;
 
-    L->YValType = type;
+    if (P == NULL || !pyramid_own(L))
+        return;
 
-    return (1);
+    for (level = 0; level < FL_PLOTXY_PYRAMID_LEVELS; level++)
+    {
+        b = p >> (FL_PLOTXY_PYRAMID_SHIFT * (level + 1));
+        B = &P->Level[level][b];
+        first = b << FL_PLOTXY_PYRAMID_SHIFT;
+        last = first + (1UL << FL_PLOTXY_PYRAMID_SHIFT);
+
+        if (level == 0)
+        {
+            if (last > L->DataSize)
+                last = L->DataSize;
+            B->Xmin = B->Xmax = col_x(L, line_phys(L, first));
+            B->Ymin = B->Ymax = col_y(L, line_phys(L, first));
+            for (; first < last; first++)
+                block_add(B, col_x(L, line_phys(L, first)), col_y(L, line_phys(L, first)));
+        }
+        else
+        {
+            if (last > P->Size[level - 1])
+                last = P->Size[level - 1];
+            *B = P->Level[level - 1][first];
+            for (; first < last; first++)
+            {
+                S = &P->Level[level - 1][first];
+                block_add(B, S->Xmin, S->Ymin);
+                block_add(B, S->Xmax, S->Ymax);
+            }
+        }
+    }
 }
 
 /************************************************************************
-*                     yvaltype(int)
-* Return the Y value type (time, date etc)
+*                          chunk_drop
+* Drop the oldest n points of a segmented line. The chunks they leave
+* empty go back to the pool, nothing is copied.
 ************************************************************************/
-int Fl_PlotXY::yvaltype(int line)
+static void chunk_drop(Fl_PlotXY_Line *L, unsigned long int n)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 2)
-        printf("Fl_PlotXY::yvaltype(int,int)\n");
-    if ((L = getselected(line)) == NULL)
-        return (-1); /* Data Set not avaliable */
+    unsigned long int count, c;
 
-    return (L->YValType);
-}
+    /* Only the range's edges make it out of date */
+    for (count = 0; count < n && L->BoundsValid; count++)
+        bounds_drop(L, col_x(L, line_phys(L, count)), col_y(L, line_phys(L, count)));
 
-/************************************************************************
-*                     xvalformat(int,int,int)
-* Set the X value format  %0whole.0pointslf
-************************************************************************/
-int Fl_PlotXY::xvalformat(int line, int whole, int points)
-{
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 2)
-        printf("Fl_PlotXY::xvalformat(int,int,int)\n");
-    if ((L = getselected(line)) == NULL)
-        return (0); /* Data Set not avaliable */
+    L->DataStart += n;
+    L->DataSize -= n;
+    L->XCol.Base += n;
 
-    if (whole < 10 && whole >= 0 && points < 10 && points >= 0)
+    /* Chunks wholly before the oldest point */
+    c = L->DataStart >> FL_PLOTXY_CHUNK_SHIFT;
+    if (c > 0)
     {
-        sprintf(L->XValFormat, "%%0%d.0%dlf", whole, points);
-        return (1);
+        for (count = 0; count < c; count++)
+            pool_free(L->Pool, L->Chunk[count]);
+        memmove(L->Chunk, L->Chunk + c, (L->Chunks - c) * sizeof(char *));
+        L->Chunks -= c;
+        L->DataStart -= c << FL_PLOTXY_CHUNK_SHIFT;
     }
-    return (0);
+
+    L->DataCapacity = (L->Chunks << FL_PLOTXY_CHUNK_SHIFT) - L->DataStart;
+    line_cols(L);
+}
+
+/* A segmented ring buffer keeps just its newest MaxPoints */
+static inline void chunk_keep(Fl_PlotXY_Line *L)
+{
+    if (L->Segmented && L->MaxPoints != 0 && L->DataSize > L->MaxPoints)
+        chunk_drop(L, L->DataSize - L->MaxPoints);
 }
 
 /************************************************************************
-*                     yvalformat(int,int,int)
-* Set the Y value format  %0whole.0pointslf
+*                          ring_add
+* Add a point to a ring buffer line, over writing the oldest when full
 ************************************************************************/
-int Fl_PlotXY::yvalformat(int line, int whole, int points)
+static void ring_add(Fl_PlotXY_Line *L, double X, double Y)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 2)
-        printf("Fl_PlotXY::yvalformat(int,int,int)\n");
-    if ((L = getselected(line)) == NULL)
-        return (0); /* Data Set not avaliable */
+    unsigned long int p;
 
-    if (whole < 10 && whole >= 0 && points < 10 && points >= 0)
+    if (L->DataSize < L->MaxPoints)
+        p = line_phys(L, L->DataSize);
+    else
     {
-        sprintf(L->YValFormat, "%%0%d.0%dlf", whole, points);
-        return (1);
+        /* The oldest goes and its place becomes the newest */
+        p = L->DataStart;
+        bounds_drop(L, col_x(L, p), col_y(L, p));
+        if (++L->DataStart == L->MaxPoints)
+            L->DataStart = 0;
+        L->DataSize--;
+        L->XCol.Base++;
+        L->XCol.Wrap = L->YCol.Wrap = L->DataStart;
     }
-    return (0);
-}
 
-/************************************************************************
-*                linetitle(int , const char* )
-*
-************************************************************************/
-int Fl_PlotXY::linetitle(int line, const char *title)
-{
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 2)
-        printf("Fl_PlotXY::yvalformat(int,int,int)\n");
-    if ((L = getselected(line)) == NULL)
-        return (0); /* Data Set not avaliable */
+    /* The range takes in the point as stored */
+    col_set(&L->XCol, p, X);
+    col_set(&L->YCol, p, Y);
+    bounds_add(L, col_x(L, p), col_y(L, p));
 
-    L->title = title;
-    return (1);
+    L->DataSize++;
+    L->Appended++;
 }
 
-/************************************************************************
-*                         linetitle(int)
-*
-************************************************************************/
-const char *Fl_PlotXY::linetitle(int line)
+/* Move a FL_PLOTXY_STRIP line's X range to end on its newest point.
+ * The range moves in whole pixels of a w pixel wide plot so the picture
+ * can be scrolled rather than drawn again. */
+static void strip_view(Fl_PlotXY_Line *L, int w)
 {
-    Fl_PlotXY_Line *L;
-    if (P_DEBUG > 2)
-        printf("Fl_PlotXY::yvalformat(int,int,int)\n");
-    if ((L = getselected(line)) == NULL)
-        return (NULL); /* Data Set not avaliable */
+    double px;
 
-    return (L->title);
+    if (L->DataSize == 0 || L->StripSpan <= 0.0 || w <= 0)
+        return;
+
+    px = L->StripSpan / w;
+    L->Xmax = ceil(col_x(L, line_phys(L, L->DataSize - 1)) / px) * px;
+    L->Xmin = L->Xmax - L->StripSpan;
 }
 
 /************************************************************************
-*                              draw
+*                          Polylines
+* poly_vertex collects pixel positions and poly_end draws them with a
+* single fl_end_line (one XDrawLines) or fl_end_points.
+* A vertex on the same pixel as the one before is dropped.
+* A segment wholly off one side of the plot lifts the pen, so nothing
+* off the plot is drawn.
 ************************************************************************/
-void Fl_PlotXY::draw()
+static void poly_end(Fl_PlotXY_Polyline *P)
 {
     int count;
 
-    Fl_PlotXY_Line *L;
-
-    Fl_Color col = color();
-    draw_box(box(), col);
-
-    if (P_DEBUG > 2)
-        printf("Fl_PlotXY:: draw()\n");
-
-    /* Stop any drawing outside of the boxed area */
-    fl_push_clip(x() + 2, y() + 2, w() - 4, h() - 4);
-
-    /* Calculate the plotable area */
-    calc_plot_area();
-
-    /* Clip the graph only area */
-    fl_push_clip(PX, PY, PW, PH + 1);
-
-    /* Check all lines for drawing */
-    for (count = 0; count < FL_PLOTXY_MAXLINES; count++)
+    if (P->Count > (P->Mode == FL_PLOTXY_DOT ? 0 : 1))
     {
+        if (P->Mode == FL_PLOTXY_DOT)
+            fl_begin_points();
+        else
+            fl_begin_line();
 
-        /* Check for Valid data to plot and if it is on or off */
-        if ((L = getselected(count)) != NULL)
-        {
-            if (L->Displayed == 1)
-            {
-                switch (L->ScaleMode)
-                {
-                default:
-                case FL_PLOTXY_AUTO:
-                    if (P_DEBUG > 1)
-                        printf(" FL_PLOTXY_AUTO\n");
-                    minmax(L);
-                    break;
+        for (count = 0; count < P->Count; count++)
+            fl_transformed_vertex(P->X[count], P->Y[count]);
 
-                case FL_PLOTXY_FIXED:
-                    if (P_DEBUG > 1)
-                        printf(" FL_PLOTXY_FIXED\n");
-                    MinX = L->Xmin;
-                    MaxX = L->Xmax;
-                    MinY = L->Ymin;
-                    MaxY = L->Ymax;
-                    break;
-                }
+        if (P->Mode == FL_PLOTXY_DOT)
+            fl_end_points();
+        else
+            fl_end_line();
+    }
+    P->Count = 0;
+}
 
-                if (P_DEBUG > 1)
-                    printf(" MaxX=%lf, MaxY=%lf\n MinX=%lf, MinY=%lf\n", MaxX, MaxY, MinX, MinY);
+static void poly_begin(Fl_PlotXY_Polyline *P, int mode, int left, int top, int right, int bottom)
+{
+    P->Mode = mode;
+    P->Count = 0;
+    P->Left = left;
+    P->Top = top;
+    P->Right = right;
+    P->Bottom = bottom;
+}
 
-                /* Plot the Graph on the Display */
-                if (L->data != NULL)
-                {
-                    switch (L->DrawMode)
-                    {
-                    /* Plot Using Dots */
-                    default:
-                    case FL_PLOTXY_DOT:
-                        plot_dot(L);
-                        break;
-
-                    /* Plot Using Lines */
-                    case FL_PLOTXY_LINE:
-                        plot_line(L);
-                        break;
-                    }
-                }
-            }
-        }
-    }
+static inline void poly_vertex(Fl_PlotXY_Polyline *P, int x, int y)
+{
+    int lx, ly;
 
-    /* Draw the Vertical Line */
-    if (vlineenable())
+    if (P->Mode == FL_PLOTXY_DOT)
     {
-        if ((L = getselected(vlinesel())) != NULL)
-        {
-            draw_vline(L);
-        }
+        if (x < P->Left || x > P->Right || y < P->Top || y > P->Bottom)
+            return; /* Off the plot */
+        if (P->Count > 0 && x == P->X[P->Count - 1] && y == P->Y[P->Count - 1])
+            return; /* Same pixel */
+        if (P->Count == FL_PLOTXY_VERTICES)
+            poly_end(P);
     }
-
-    /* Pop the Graph only area */
-    fl_pop_clip();
-
-    /* Draw the Axis Markings and Labels */
-    for (count = 0; count < FL_PLOTXY_MAXLINES; count++)
+    else if (P->Count > 0)
     {
-        if ((L = getselected(count)) != NULL)
+        lx = P->X[P->Count - 1];
+        ly = P->Y[P->Count - 1];
+        if (x == lx && y == ly)
+            return; /* Same pixel */
+
+        if ((x < P->Left && lx < P->Left) || (x > P->Right && lx > P->Right) ||
+            (y < P->Top && ly < P->Top) || (y > P->Bottom && ly > P->Bottom))
         {
-            draw_scales(L);    /* Draw Axis       */
-            draw_axislabel(L); /* Draw Axis Label */
+            /* Off the plot - lift the pen */
+            poly_end(P);
         }
-    }
-
-    /* Draw the Line Labels */
-    for (count = 0; count < FL_PLOTXY_MAXLINES; count++)
-    {
-        if ((L = getselected(count)) != NULL)
+        else if (P->Count == FL_PLOTXY_VERTICES)
         {
-            draw_linelabel(L);
+            /* Buffer full - carry on from the last vertex */
+            poly_end(P);
+            P->X[0] = lx;
+            P->Y[0] = ly;
+            P->Count = 1;
         }
     }
 
-    /* Pop from the clipped area */
-    fl_pop_clip();
-
-    /* Draw the label last so it is on the TOP */
-    draw_label();
+    P->X[P->Count] = x;
+    P->Y[P->Count] = y;
+    P->Count++;
+
+    /* Keep the area drawn on */
+    if (x < P->X1)
+        P->X1 = x;
+    if (x > P->X2)
+        P->X2 = x;
+    if (y < P->Y1)
+        P->Y1 = y;
+    if (y > P->Y2)
+        P->Y2 = y;
 }
 
 /************************************************************************
-*                           calc_plot_area
+*                          line_init
+* Set up a new line slot, not in use yet
 ************************************************************************/
-void Fl_PlotXY::calc_plot_area(void)
+static void line_init(Fl_PlotXY_Line *L)
 {
-    Fl_PlotXY_Line *L;
-    int count;
-    int tx, ty, tw, th, ux, uy, uw, uh;
-    int mw, mh;
-
-    if (P_DEBUG > 1)
-        printf("Fl_PlotXY::calc_plot_area(void)\n");
+    L->LineNumber = -1;            /* Line Number for this array        */
+    L->NextFree = -1;
+    L->Displayed = 0;
+    L->DrawMode = FL_PLOTXY_LINE;  /* Line Drawing Mode          */
+    L->ScaleMode = FL_PLOTXY_AUTO; /* Scaling Mode               */
 
-    /* Check if using graduations etc
- *  and calc Plot Area required (Scans ALL Values)*/
+    L->Xmax = 0.0; /* Maximum Axis Value for this line  */
+    L->Ymax = 0.0;
+    L->Xmin = 0.0; /* Minimum Axis Value for this line  */
+    L->Ymin = 0.0;
+    L->title = NULL; /* Pointer to string array for title */
+    L->C = FL_BLACK; /* Line and title Colour             */
 
-    ux = PX = x() + 2;
-    uy = PY = y() + 2;
-    uw = PW = w() - 5;
-    uh = PH = h() - 5;
+    L->DataSize = 0;     /* Number of Points in array         */
+    L->DataCapacity = 0; /* Number of Points allocated        */
+    L->MaxPoints = 0;    /* Grow without limit                */
+    L->DataStart = 0;    /* Oldest point is first in array    */
+    L->BoundsValid = 0;  /* No data range yet                 */
+    L->data = NULL;      /* Pointer to data for this line     */
+    L->Cols = NULL;      /* No columnar data                  */
+    L->Columnar = 0;     /* Interleaved X,Y points            */
+    L->Segmented = 0;    /* All the points in one block       */
+    L->Chunk = NULL;     /* No chunks                         */
+    L->Chunks = 0;
+    L->ChunkSlots = 0;
+    L->External = 0;     /* Points owned by the line          */
+    L->Release = NULL;
+    L->ReleaseArg = NULL;
+    L->Group = NULL;     /* X of its own                      */
+    L->XCol.Type = FL_PLOTXY_DOUBLE; /* X and Y stored as doubles */
+    L->XCol.Gain = 1.0;
+    L->XCol.Offset = 0.0;
+    L->XCol.Base = 0;
+    L->YCol = L->XCol;
+    line_cols(L);
+    L->Pyramid = NULL;   /* No Min/Max pyramid                */
+    L->DrawnSize = 0;    /* Nothing drawn yet                 */
+    L->Appended = 0;
+    L->StripSpan = 0.0;  /* No strip chart width            */
+
+    L->XLabel = NULL; /* Pointer to string for X label     */
+    L->YLabel = NULL; /* Pointer to string for Y label     */
+
+    sprintf(L->XValFormat, "%%0.02lf"); /* Formatter for X Value display */
+    sprintf(L->YValFormat, "%%0.02lf"); /* Formatter for Y Value display */
+}
 
-    if (P_DEBUG > 1)
-        printf(" Basic => PX=%d, PY=%d, PW=%d, PH=%d\n", PX, PY, PW, PH);
+/************************************************************************
+*                          Fl_PlotXY
+************************************************************************/
+Fl_PlotXY::Fl_PlotXY(int X, int Y, int W, int H, const char *l)
+    : Fl_Widget(X, Y, W, H, l)
+{
+    /* Border box to start with */
+    box(FL_EMBOSSED_BOX);
+    color(FL_WHITE);
 
-    fl_font(AxisFontFace, AxisFontSize);
+    /* Set Basic Fonts and Sizes */
+    AxisFontSize = 12;
+    AxisFontFace = FL_HELVETICA;
+    /* Other Options are FL_HELVETICA, FL_COURIER, FL_TIMES, FL_SCREEN */
 
-    for (count = 0; count < FL_PLOTXY_MAXLINES; count++)
-    {
-        if ((L = getselected(count)) != NULL && L->Displayed)
-        {
-            tx = PX;
-            ty = PY;
-            tw = PW;
-            th = PH;
+    AxisTextSpaceX = 15; /* Text space for X Axis Display */
+    AxisTextSpaceY = 60; /* Text Spaceing for Y Axis Display */
 
-            mw = 0;
-            mh = 0;
-            fl_measure("H", mw, mh, 1); /* Get Text Height */
+    /* No lines yet */
+    LineData = NULL;
+    LineSlots = 0;
+    LineAlloc = 0;
+    FreeLine = -1;
+    Shown = NULL;
+    ShownCount = 0;
+    memset(&Pool, 0, sizeof(Pool));
+    Pool.Limit = FL_PLOTXY_POOL_LIMIT;
+    Groups = NULL;
+    GroupSlots = 0;
+    LoadThreads = 0;
+    Job = NULL;
+    AsyncCb = NULL;
+    AsyncArg = NULL;
+    AsyncPreview = 0;
+
+    /* Vector kernels, while there is only this thread */
+    if (SimdLevel < 0)
+        simd_pick(FL_PLOTXY_SIMD_AVX512);
 
-            if (L->XMark & FL_PLOTXY_MARK_ON)
-            {
-                th -= 10; /* Size of the Marking */
-                if ((L->XMark & FL_PLOTXY_MARK_LABEL) && L->XLabel != NULL)
-                    th -= (mh + 2);
-                if (L->XMark & FL_PLOTXY_MARK_VAL)
-                    th -= (mh + 2);
-                //if(L->XMark & FL_PLOTXY_MARK_NAME)  tw -= 40;
-            }
+    /* Dont have any line shown */
+    vlinepos(0);
+    vlineenable(0);
+    vlinesel(-1);
 
-            if (L->YMark & FL_PLOTXY_MARK_ON)
-            {
-                tx += 10;
-                tw -= 10;
-                if ((L->YMark & FL_PLOTXY_MARK_LABEL) && L->YLabel != NULL)
-                {
-                    mw = 0;
-                    mh = 0;
-                    fl_measure(L->YLabel, mw, mh, 1);
-                    tx += (mh + 2);
-                    tw -= (mh + 2);
-                }
-                if (L->YMark & FL_PLOTXY_MARK_VAL)
-                {
-                    tx += AxisTextSpaceY;
-                    tw -= AxisTextSpaceY;
-                }
-                //if((L->YMark & FL_PLOTXY_MARK_NAME))continue;
-            }
+    /* Nothing cached yet */
+    Cache = 0;
+    CacheEnable = 1;
+    CacheValid = 0;
+    CacheW = CacheH = 0;
+    CacheX = CacheY = 0;
+    CacheColor = color();
+    CacheBox = box();
+    Strip = 0;
+    StripW = StripH = 0;
+
+    /* No plot area until the first draw */
+    PX = PY = PW = PH = 0;
+}
 
-            /* Check for changes to min/max range */
-            if (tx > ux)
-                ux = tx;
-            if (ty > uy)
-                uy = ty;
-            if (tw < uw)
-                uw = tw;
-            if (th < uh)
-                uh = th;
-        }
-    }
+static void job_orphan(Fl_PlotXY_Job *J); /* Background jobs, at the end */
 
-    /* Set the GRAPH drawing Area */
-    PX = ux;
-    PY = uy;
-    PW = uw;
-    PH = uh;
+/************************************************************************
+*                          ~Fl_PlotXY
+************************************************************************/
+Fl_PlotXY::~Fl_PlotXY(void)
+{
+    int count;
 
-    if (P_DEBUG > 1)
-        printf(" After => PX=%d, PY=%d, PW=%d, PH=%d\n", PX, PY, PW, PH);
+    if (Job != NULL)
+        job_orphan(Job); /* Stop it before the lines go */
+    removeall();         /* Free All allocated memory */
+
+    for (count = 0; count < LineSlots; count++)
+        free(LineData[count]);
+    free(LineData);
+    free(Shown);
+    free(Groups); /* Groups went with their last line */
+    pool_release(&Pool);
+
+    if (Cache)
+        fl_delete_offscreen(Cache);
+    if (Strip)
+        fl_delete_offscreen(Strip);
 }
 
 /************************************************************************
-*                           plot_dot
+*                          resize
 ************************************************************************/
-void Fl_PlotXY::plot_dot(Fl_PlotXY_Line *L)
+void Fl_PlotXY::resize(int X, int Y, int W, int H)
 {
+    /* Moving is fine, a new size needs a new picture */
+    if (W != w() || H != h())
+        invalidate();
 
-    int xx, yy;
-    Fl_PlotXY_Data *TempData;
-    unsigned long int count;
+    Fl_Widget::resize(X, Y, W, H);
+}
 
-    if (P_DEBUG > 3)
-        printf("Fl_PlotXY::plot_dot()\n");
+/************************************************************************
+*                          cacheenable
+* Turn offscreen cache on/off
+************************************************************************/
+void Fl_PlotXY::cacheenable(int e)
+{
+    CacheEnable = e;
+    if (!e && Cache)
+    {
+        fl_delete_offscreen(Cache);
+        Cache = 0;
+    }
+    if (!e && Strip)
+    {
+        fl_delete_offscreen(Strip);
+        Strip = 0;
+    }
+    invalidate();
+}
 
-    TempData = L->data;
+/************************************************************************
+*                          version
+************************************************************************/
+const char *Fl_PlotXY::version(void)
+{
+    return (VERSION_FL_PLOTXY);
+}
 
-    /* Check for Valid Data */
-    if (TempData == NULL)
-        return;
+/************************************************************************
+*                          simd
+* Vector kernel set in use
+************************************************************************/
+int Fl_PlotXY::simd(void)
+{
+    if (SimdLevel < 0)
+        simd_pick(FL_PLOTXY_SIMD_AVX512);
+    return (SimdLevel);
+}
 
-    /* Set up zoom scale etc */
-    setscale(L);
+/************************************************************************
+*                          simd
+* Use no better than the given vector kernel set
+* Refused while a background job may be using the kernels
+************************************************************************/
+int Fl_PlotXY::simd(int level)
+{
+    if (SimdJobs > 0)
+        return (SimdLevel);
+    return (simd_pick(level));
+}
 
-    /* Set Line Colour */
-    fl_color(L->C);
+/************************************************************************
+*                          getselected
+* returns pointer to data selected by int
+* returns NULL if invalid
+************************************************************************/
+Fl_PlotXY_Line *Fl_PlotXY::getselected(int line)
+{
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::getselected(int line)\n");
+
+    if (line >= LineSlots || line < 0)
+        return (NULL);
+
+    if (LineData[line]->LineNumber == -1)
+        return (NULL);
+
+    return (LineData[line]);
+}
+
+/************************************************************************
+*                          showlist
+* Show or hide a line, keeping Shown in line number order
+************************************************************************/
+void Fl_PlotXY::showlist(Fl_PlotXY_Line *L, int on)
+{
+    int lo = 0, hi = ShownCount, mid;
 
-    /* Plot the Data */
-    for (count = 0; count < L->DataSize; count++)
+    /* Find where the line is, or would go */
+    while (lo < hi)
     {
-        xx = PX + (int)((TempData->X + L->X_Left) * L->X_Scale);
-        yy = PY + PH - (int)((TempData->Y + L->Y_Bottom) * L->Y_Scale);
+        mid = (lo + hi) / 2;
+        if (Shown[mid] < L->LineNumber)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
 
-        fl_point(xx, yy);
-        TempData++;
+    if (on && (lo == ShownCount || Shown[lo] != L->LineNumber))
+    {
+        memmove(Shown + lo + 1, Shown + lo, (ShownCount - lo) * sizeof(int));
+        Shown[lo] = L->LineNumber;
+        ShownCount++;
+    }
+    else if (!on && lo < ShownCount && Shown[lo] == L->LineNumber)
+    {
+        memmove(Shown + lo, Shown + lo + 1, (ShownCount - lo - 1) * sizeof(int));
+        ShownCount--;
     }
+
+    L->Displayed = on;
 }
 
 /************************************************************************
-*                            plot_line
+*                          newline
+* Create a new Data set
+* returns descripter to line
 ************************************************************************/
-void Fl_PlotXY::plot_line(Fl_PlotXY_Line *L)
+int Fl_PlotXY::newline(double Xmin, double Ymin, double Xmax, double Ymax, int scalemode, Fl_Color C, const char *t)
 {
-    int xx, yy, lx, ly;
-    Fl_PlotXY_Data *TempData;
-    unsigned long int count;
+    int count, n;
+    Fl_PlotXY_Line *L, **Slots = NULL;
+    int *List = NULL;
 
-    if (P_DEBUG > 3)
-        printf("Fl_PlotXY::plot_line()\n");
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::newline(double,double,double,double,Fl_Color,cont char*\n");
 
-    TempData = L->data;
+    if (FreeLine != -1)
+    {
+        /* Reuse the last line removed */
+        count = FreeLine;
+        L = LineData[count];
+        FreeLine = L->NextFree;
+    }
+    else
+    {
+        /* Make room for another line, twice as many slots when full */
+        if (LineSlots == LineAlloc)
+        {
+            n = LineAlloc ? 2 * LineAlloc : FL_PLOTXY_LINES;
+            if ((Slots = (Fl_PlotXY_Line **)realloc(LineData, n * sizeof(Fl_PlotXY_Line *))) != NULL)
+                LineData = Slots;
+            if ((List = (int *)realloc(Shown, n * sizeof(int))) != NULL)
+                Shown = List;
+            if (Slots != NULL && List != NULL)
+                LineAlloc = n;
+        }
 
-    /* Check for Data */
-    if (TempData == NULL)
-        return;
+        L = (LineSlots < LineAlloc) ? (Fl_PlotXY_Line *)malloc(sizeof(Fl_PlotXY_Line)) : NULL;
+        if (L == NULL)
+        {
+            if (P_DEBUG > 0)
+                printf(" ERROR: Out of line allocations\n");
+            return (-1);
+        }
+        line_init(L);
+        L->Pool = &Pool;
+        count = LineSlots++;
+        LineData[count] = L;
+    }
 
-    /* Set up zoom scale etc */
-    setscale(L);
+    /* Create the New Data */
+    L->LineNumber = count;
+    L->DrawMode = FL_PLOTXY_LINE; /* Line Drawing Mode         */
 
-    /* Get First Point of Data*/
+    L->ScaleMode = scalemode;
 
-    lx = PX + (int)((TempData->X + L->X_Left) * L->X_Scale);
-    ly = PY + PH - (int)((TempData->Y + L->Y_Bottom) * L->Y_Scale);
+    showlist(L, 1); /* Turn Line Display ON */
 
-    TempData++;
+    L->XMark = 0;       /* X Graduation Marks off         */
+    L->YMark = 0;       /* Y Graduation Marks off         */
+    L->XMarkSize = 0.0; /* X Graduation step  off         */
+    L->YMarkSize = 0.0; /* Y Graduation step  off         */
 
-    /* Set Line Colour */
-    fl_color(L->C);
+    L->XValType = 0; /* Type of data for X Axis Value     */
+    L->YValType = 0; /* Type of data for Y Axis Value     */
+
+    if (Xmin < Xmax)
+    {
+        L->Xmax = Xmax;
+        L->Xmin = Xmin;
+    }
+    else
+    {
+        L->Xmax = Xmin;
+        L->Xmin = Xmax;
+    }
 
-    /* Plot the Data */
-    for (count = 1; count < L->DataSize; count++)
+    if (Ymin < Ymax)
+    {
+        L->Ymax = Ymax;
+        L->Ymin = Ymin;
+    }
+    else
     {
-        xx = PX + (int)((TempData->X + L->X_Left) * L->X_Scale);
-        yy = PY + PH - (int)((TempData->Y + L->Y_Bottom) * L->Y_Scale);
-        fl_line(lx, ly, xx, yy);
-        lx = xx;
-        ly = yy;
-        TempData++;
+        L->Ymax = Ymin;
+        L->Ymin = Ymax;
     }
+
+    L->StripSpan = L->Xmax - L->Xmin; /* FL_PLOTXY_STRIP width */
+
+    L->title = t; /* Pointer to string array for title */
+    L->C = C;     /* Line and title Colour             */
+
+    L->DataSize = 0; /* Number of Points in array         */
+
+    invalidate();
+
+    return (count);
 }
 
 /************************************************************************
-*                          draw_scales
+*                            grow
+* Make room for at least size points in the line.
+* Capacity doubles so a run of single adds is O(1) amortized.
 ************************************************************************/
-void Fl_PlotXY::draw_scales(Fl_PlotXY_Line *L)
+int Fl_PlotXY::grow(Fl_PlotXY_Line *L, unsigned long int size)
 {
-    double start, finish, step, tmp;
+    unsigned long int cap;
+    int ok;
 
-    int xx, yy, tw, th, h, m, s, r, tt;
-    char str[20];
+    if (size <= L->DataCapacity)
+        return (1); /* Already big enough */
 
-    fl_font(AxisFontFace, AxisFontSize);
+    /* Segmented - more chunks, nothing moves */
+    if (L->Segmented)
+    {
+        if (chunk_add(L, size))
+            return (1);
+        if (P_DEBUG > 0)
+            printf(" ERROR: Not Enough Space\n");
+        return (0);
+    }
+
+    if (size > (unsigned long int)-1 / sizeof(Fl_PlotXY_Data))
+        return (0); /* Would overflow */
+
+    cap = L->DataCapacity ? L->DataCapacity : 16;
+    while (cap < size)
+    {
+        if (cap > ((unsigned long int)-1 / sizeof(Fl_PlotXY_Data)) / 2)
+        {
+            cap = size; /* Can not double any more */
+            break;
+        }
+        cap *= 2;
+    }
 
     if (P_DEBUG > 1)
-        printf("Fl_PlotXY::draw_scales(Fl_PlotXY_Line* L)\n");
+        printf(" Growing line %d to %ld points\n", L->LineNumber, cap);
 
-    /***** XAXIS ******/
-    if ((L->XMark & FL_PLOTXY_MARK_ON) && (L->XMarkSize != 0.0) && L->Displayed == 1)
+    ok = store_resize(L, cap);
+
+    /* Doubling failed - try for just what was asked */
+    if (!ok && cap > size)
+        ok = store_resize(L, size);
+
+    if (!ok)
     {
-        /* Calculate the graduations using limits and scale etc */
+        if (P_DEBUG > 0)
+            printf(" ERROR: Not Enough Space\n");
+        return (0);
+    }
 
-        step = L->XMarkSize;
+    return (1);
+}
 
-        start = (int)(L->Xmin / L->XMarkSize) * L->XMarkSize;
+/************************************************************************
+*                            add
+* Add data to selected line
+************************************************************************/
+int Fl_PlotXY::add(int line, double X, double Y)
+{
+    Fl_PlotXY_Line *L;
+    unsigned long int p;
 
-        finish = L->Xmax;
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::add(int,double,double)\n");
 
-        if (P_DEBUG > 1)
-        {
-            printf(" Xmin=%lf, Xmax=%lf, XMarkSize=%lf, X_Scale=%lf\n", L->Xmin, L->Xmax, L->XMarkSize, L->X_Scale);
-            printf(" step=%lf, start=%lf, finish=%lf\n", step, start, finish);
-        }
+    if ((L = getselected(line)) == NULL || L->External)
+        return 0; /* Get Data, not a buffer shown as it is */
 
-        /* Set Line Colour */
-        fl_color(L->C);
+    /* Ring buffers never grow */
+    if (L->MaxPoints != 0 && !L->Segmented)
+    {
+        ring_add(L, X, Y);
+        return (1);
+    }
 
-        for (; start < finish; start += step)
-        {
-            xx = PX + (int)((start + L->X_Left) * L->X_Scale);
-            yy = PY + PH + 3;
-            fl_line(xx, yy, xx, yy + 5);
+    /* Allocate More memory when full */
+    if (L->DataSize >= L->DataCapacity && !grow(L, L->DataSize + 1))
+        return (0); /* Not Enough Space!! */
 
-            /* Print Value */
-            if ((L->XMark & FL_PLOTXY_MARK_VAL))
-            {
+    /* Add New Data, the range takes it in as stored */
+    p = line_phys(L, L->DataSize);
+    col_set(&L->XCol, p, X);
+    col_set(&L->YCol, p, Y);
+    bounds_add(L, col_x(L, p), col_y(L, p));
 
-                tt = (int)start;
+    L->DataSize++;
+    L->Appended++;
+    pyramid_add(L, L->DataSize - 1);
+    chunk_keep(L);
 
-                r = (int)((start - (double)tt) * 100); /* hundReds */
+    if (P_DEBUG > 1)
+        printf(" DataSize=%ld  -> %ld bytes\n", L->DataSize, L->DataSize * line_pointsize(L));
 
-                h = tt / 3600; /* Hours */
-                tt = tt - (h * 3600);
-                m = tt / 60; /* Minutes */
-                tt = tt - (m * 60);
-                s = tt; /* Seconds */
-                tt -= s;
+    return (1);
+}
 
-                switch (L->XValType)
-                {
-                default:
-                case FL_PLOTXY_VAL_NUMBER:
-                    //sprintf(str,"%0.3f",start);
-                    sprintf(str, L->XValFormat, start);
-                    break;
+/************************************************************************
+*                            add
+* Add the next sample to a uniform X line
+************************************************************************/
+int Fl_PlotXY::add(int line, double Y)
+{
+    Fl_PlotXY_Line *L;
 
-                case FL_PLOTXY_VAL_TIMEh:
-                    sprintf(str, "%02d", r);
-                    break;
+    if ((L = getselected(line)) == NULL || L->XCol.Type != FL_PLOTXY_UNIFORM)
+        return (0); /* Get Data */
 
-                case FL_PLOTXY_VAL_TIMESh:
-                    sprintf(str, "%02d.%02d", s, r);
-                    break;
+    return (add(line, 0.0, Y));
+}
 
-                case FL_PLOTXY_VAL_TIMEMSh:
-                    sprintf(str, "%02d:%02d.%02d", m, s, r);
-                    break;
+/************************************************************************
+*                            add
+* Add a block of samples to a uniform X line
+************************************************************************/
+int Fl_PlotXY::add(int line, const double *Y, unsigned long int n)
+{
+    Fl_PlotXY_Line *L;
 
-                case FL_PLOTXY_VAL_TIMEHMSh:
-                    sprintf(str, "%02d:%02d:%02d.%02d", h, m, s, r);
-                    break;
+    if ((L = getselected(line)) == NULL || L->XCol.Type != FL_PLOTXY_UNIFORM)
+        return (0); /* Get Data */
 
-                case FL_PLOTXY_VAL_TIMES:
-                    sprintf(str, "%02d", s);
-                    break;
+    /* X is not read */
+    return (add(line, Y, 0, Y, 1, n));
+}
 
-                case FL_PLOTXY_VAL_TIMEMS:
-                    sprintf(str, "%02d:%02d", m, s);
-                    break;
+/************************************************************************
+*                            add
+* Add a block of points from separate X and Y arrays
+************************************************************************/
+int Fl_PlotXY::add(int line, const double *X, const double *Y, unsigned long int n)
+{
+    return (add(line, X, 1, Y, 1, n));
+}
 
-                case FL_PLOTXY_VAL_TIMEHMS:
-                    sprintf(str, "%02d:%02d:%02d", h, m, s);
-                    break;
+/************************************************************************
+*                            add
+* Add a block of interleaved points
+************************************************************************/
+int Fl_PlotXY::add(int line, const Fl_PlotXY_Data *D, unsigned long int n)
+{
+    Fl_PlotXY_Line *L;
+    unsigned long int first, p;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::add(int,const Fl_PlotXY_Data*,unsigned long int)\n");
+
+    if ((L = getselected(line)) == NULL || D == NULL || L->External)
+        return 0; /* Get Data */
+
+    if (n == 0)
+        return (1);
+
+    if (L->MaxPoints != 0)
+    {
+        /* Only the newest MaxPoints can survive */
+        if (n > L->MaxPoints)
+        {
+            D += n - L->MaxPoints;
+            n = L->MaxPoints;
+        }
+        if (!L->Segmented)
+        {
+            for (; n > 0; n--, D++)
+                ring_add(L, D->X, D->Y);
+            return (1);
+        }
+    }
+
+    /* Room for the whole block in one go */
+    if (n > (unsigned long int)-1 - L->DataSize || !grow(L, L->DataSize + n))
+        return (0);
+
+    first = L->DataSize;
+    L->Appended += n;
+    if (!L->Columnar && !L->Segmented)
+    {
+        memcpy(L->data + L->DataSize, D, sizeof(Fl_PlotXY_Data) * n);
+        for (; n > 0; n--, D++, L->DataSize++)
+            bounds_add(L, D->X, D->Y);
+    }
+    else
+    {
+        p = line_phys(L, first);
+        col_put(&L->XCol, p, &D->X, sizeof(Fl_PlotXY_Data) / sizeof(double), n);
+        col_put(&L->YCol, p, &D->Y, sizeof(Fl_PlotXY_Data) / sizeof(double), n);
+        for (; n > 0; n--, p++, L->DataSize++)
+            bounds_add(L, col_x(L, p), col_y(L, p));
+    }
+    pyramid_add(L, first);
+    chunk_keep(L);
+
+    return (1);
+}
+
+/************************************************************************
+*                            add
+* Add a block of points from strided arrays
+************************************************************************/
+int Fl_PlotXY::add(int line, const double *X, int xstride, const double *Y, int ystride, unsigned long int n)
+{
+    Fl_PlotXY_Line *L;
+    unsigned long int count, first, p;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::add(int,const double*,int,const double*,int,unsigned long int)\n");
+
+    if ((L = getselected(line)) == NULL || X == NULL || Y == NULL || L->External)
+        return 0; /* Get Data */
+
+    if (n == 0)
+        return (1);
+
+    if (L->MaxPoints != 0)
+    {
+        /* Only the newest MaxPoints can survive */
+        if (n > L->MaxPoints)
+        {
+            X += (n - L->MaxPoints) * xstride;
+            Y += (n - L->MaxPoints) * ystride;
+            n = L->MaxPoints;
+        }
+        if (!L->Segmented)
+        {
+            for (; n > 0; n--, X += xstride, Y += ystride)
+                ring_add(L, *X, *Y);
+            return (1);
+        }
+    }
+
+    /* Room for the whole block in one go */
+    if (n > (unsigned long int)-1 - L->DataSize || !grow(L, L->DataSize + n))
+        return (0);
+
+    first = L->DataSize;
+    L->Appended += n;
+
+    /* A column at a time */
+    p = line_phys(L, first);
+    col_put(&L->XCol, p, X, xstride, n);
+    col_put(&L->YCol, p, Y, ystride, n);
+
+    for (count = p; count < p + n; count++, L->DataSize++)
+        bounds_add(L, col_x(L, count), col_y(L, count));
+    pyramid_add(L, first);
+    chunk_keep(L);
+
+    return (1);
+}
+
+/************************************************************************
+*                            reserve
+* Pre-allocate room for n points
+************************************************************************/
+int Fl_PlotXY::reserve(int line, unsigned long int n)
+{
+    Fl_PlotXY_Line *L;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::reserve(int,unsigned long int)\n");
+
+    if ((L = getselected(line)) == NULL)
+        return 0; /* Get Data */
+
+    if (n <= L->DataCapacity)
+        return (1); /* Never shrinks */
+
+    if (L->MaxPoints != 0 || L->External)
+        return (0); /* Ring buffer size is set by maxpoints */
+
+    if (n > (unsigned long int)-1 / sizeof(Fl_PlotXY_Data))
+        return (0); /* Would overflow */
+
+    if (!(L->Segmented ? chunk_add(L, n) : store_resize(L, n)))
+    {
+        if (P_DEBUG > 0)
+            printf(" ERROR: Not Enough Space\n");
+        return (0);
+    }
+
+    return (1);
+}
+
+/************************************************************************
+*                            capacity
+* Return number of points allocated
+************************************************************************/
+unsigned long int Fl_PlotXY::capacity(int line)
+{
+    Fl_PlotXY_Line *L;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::capacity(int)\n");
+
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Get Data */
+
+    return (L->DataCapacity);
+}
+
+/************************************************************************
+*                          shrink_to_fit
+* Give back storage not used by the points
+************************************************************************/
+int Fl_PlotXY::shrink_to_fit(int line)
+{
+    Fl_PlotXY_Line *L;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::shrink_to_fit(int)\n");
+
+    if ((L = getselected(line)) == NULL)
+        return 0; /* Get Data */
+
+    if (L->DataSize == L->DataCapacity || (L->MaxPoints != 0 && !L->Segmented) || L->External)
+        return (1); /* Nothing to give back */
+
+    if (L->DataSize == 0)
+    {
+        store_free(L);
+        return (1);
+    }
+
+    /* Segmented - the chunks past the newest point */
+    if (L->Segmented)
+    {
+        chunk_trim(L);
+        return (1);
+    }
+
+    return (store_resize(L, L->DataSize)); /* Old block is still valid on failure */
+}
+
+/************************************************************************
+*                          poolsize
+* Most bytes of freed point storage to keep
+************************************************************************/
+void Fl_PlotXY::poolsize(unsigned long int bytes)
+{
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::poolsize(unsigned long int)\n");
+
+    Pool.Limit = bytes;
+    pool_trim(&Pool, bytes);
+}
+
+/************************************************************************
+*                          maxpoints
+* Keep only the newest n points in a ring buffer, 0 = no limit
+************************************************************************/
+int Fl_PlotXY::maxpoints(int line, unsigned long int n)
+{
+    Fl_PlotXY_Line *L;
+    unsigned long int keep, cap;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::maxpoints(int,unsigned long int)\n");
+
+    if ((L = getselected(line)) == NULL || L->External)
+        return 0; /* Get Data */
+    invalidate();
+
+    if (n == L->MaxPoints)
+        return (1);
+
+    /* Pyramid blocks can not follow a ring buffer around */
+    if (n != 0)
+        pyramid_free(L);
+
+    /* Segmented - nothing moves, the oldest points past n are dropped */
+    if (L->Segmented)
+    {
+        L->MaxPoints = n;
+        chunk_keep(L);
+        line_cols(L);
+        return (1);
+    }
+
+    /* Newest points that fit in the new size */
+    keep = L->DataSize;
+    if (n != 0 && keep > n)
+        keep = n;
+    cap = n != 0 ? n : keep;
+
+    /* Copy them across oldest first so the new buffer starts unwrapped */
+    if (!store_move(L, cap, L->Columnar, 0, L->DataSize - keep, keep, &L->XCol, &L->YCol))
+    {
+        if (P_DEBUG > 0)
+            printf(" ERROR: Not Enough Space\n");
+        return (0);
+    }
+
+    if (keep < L->DataSize)
+        L->BoundsValid = 0; /* May have dropped a min or max */
+    L->DataSize = keep;
+    L->MaxPoints = n;
+    line_cols(L);
+
+    return (1);
+}
+
+/************************************************************************
+*                          maxpoints
+* Return ring buffer size, 0 if not a ring buffer
+************************************************************************/
+unsigned long int Fl_PlotXY::maxpoints(int line)
+{
+    Fl_PlotXY_Line *L;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::maxpoints(int)\n");
+
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Get Data */
+
+    return (L->MaxPoints);
+}
+
+/************************************************************************
+*                          columnar
+* Move a line's points to separate X and Y arrays, or back
+************************************************************************/
+int Fl_PlotXY::columnar(int line, int on)
+{
+    Fl_PlotXY_Line *L;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::columnar(int,int)\n");
+
+    if ((L = getselected(line)) == NULL || L->External)
+        return 0; /* Get Data */
+
+    on = on ? 1 : 0;
+    if (on == L->Columnar)
+        return (1);
+
+    if (L->XCol.Type != FL_PLOTXY_DOUBLE || L->YCol.Type != FL_PLOTXY_DOUBLE)
+        return (0); /* Only doubles interleave */
+
+    /* Nothing stored yet - just change how it will be */
+    if (L->DataCapacity == 0)
+    {
+        L->Columnar = on;
+        line_cols(L);
+        return (1);
+    }
+
+    /* Same capacity, a ring buffer comes out unwrapped */
+    if (!store_move(L, L->DataCapacity, on, L->Segmented, 0, L->DataSize, &L->XCol, &L->YCol))
+    {
+        if (P_DEBUG > 0)
+            printf(" ERROR: Not Enough Space\n");
+        return (0);
+    }
+
+    return (1);
+}
+
+/************************************************************************
+*                          columnar
+* Check if a line keeps separate X and Y arrays
+************************************************************************/
+int Fl_PlotXY::columnar(int line)
+{
+    Fl_PlotXY_Line *L;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::columnar(int)\n");
+
+    if ((L = getselected(line)) == NULL)
+        return 0; /* Get Data */
+
+    return (L->Columnar);
+}
+
+/************************************************************************
+*                          segmented
+* Move a line's points into chunks, or back into one block
+************************************************************************/
+int Fl_PlotXY::segmented(int line, int on)
+{
+    Fl_PlotXY_Line *L;
+    unsigned long int cap;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::segmented(int,int)\n");
+
+    if ((L = getselected(line)) == NULL || L->External)
+        return 0; /* Get Data */
+
+    on = on ? 1 : 0;
+    if (on == L->Segmented)
+        return (1);
+
+    /* Nothing stored yet - just change how it will be */
+    if (L->DataCapacity == 0)
+    {
+        L->Segmented = on;
+        line_cols(L);
+        return (1);
+    }
+
+    /* Chunks for the points there, or one block - a whole ring buffer */
+    cap = !on && L->MaxPoints != 0 ? L->MaxPoints : L->DataSize;
+    if (!store_move(L, cap, L->Columnar, on, 0, L->DataSize, &L->XCol, &L->YCol))
+    {
+        if (P_DEBUG > 0)
+            printf(" ERROR: Not Enough Space\n");
+        return (0);
+    }
+
+    return (1);
+}
+
+/************************************************************************
+*                          segmented
+* Check if a line keeps its points in chunks
+************************************************************************/
+int Fl_PlotXY::segmented(int line)
+{
+    Fl_PlotXY_Line *L;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::segmented(int)\n");
+
+    if ((L = getselected(line)) == NULL)
+        return 0; /* Get Data */
+
+    return (L->Segmented);
+}
+
+/************************************************************************
+*                          xstore
+* Store a line's X values as float or scaled integers
+************************************************************************/
+int Fl_PlotXY::xstore(int line, int type, double gain, double offset)
+{
+    Fl_PlotXY_Line *L;
+    Fl_PlotXY_Column C;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::xstore(int,int,double,double)\n");
+
+    if ((L = getselected(line)) == NULL)
+        return 0; /* Get Data */
+
+    if (type < FL_PLOTXY_DOUBLE || type > FL_PLOTXY_UNIFORM || gain == 0.0 || gain != gain)
+        return (0);
+    invalidate();
+
+    C = L->XCol;
+    if (type == FL_PLOTXY_UNIFORM && C.Type != FL_PLOTXY_UNIFORM)
+        C.Base = 0; /* Oldest point is sample 0 */
+    C.Type = type;
+    C.Gain = gain;
+    C.Offset = offset;
+    return (retype(L, &C, &L->YCol));
+}
+
+/************************************************************************
+*                          xstore
+* Return how a line stores its X values
+************************************************************************/
+int Fl_PlotXY::xstore(int line)
+{
+    Fl_PlotXY_Line *L;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::xstore(int)\n");
+
+    if ((L = getselected(line)) == NULL)
+        return (-1); /* Get Data */
+
+    return (L->XCol.Type);
+}
+
+/************************************************************************
+*                          xstorescale
+* Return the gain and offset of a line's integer X values
+************************************************************************/
+int Fl_PlotXY::xstorescale(int line, double *gain, double *offset)
+{
+    Fl_PlotXY_Line *L;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::xstorescale(int,double*,double*)\n");
+
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Get Data */
+
+    *gain = L->XCol.Gain;
+    *offset = L->XCol.Offset;
+    return (1);
+}
+
+/************************************************************************
+*                          ystore
+* Store a line's Y values as float or scaled integers
+************************************************************************/
+int Fl_PlotXY::ystore(int line, int type, double gain, double offset)
+{
+    Fl_PlotXY_Line *L;
+    Fl_PlotXY_Column C;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::ystore(int,int,double,double)\n");
+
+    if ((L = getselected(line)) == NULL)
+        return 0; /* Get Data */
+
+    if (type < FL_PLOTXY_DOUBLE || type > FL_PLOTXY_INT32 || gain == 0.0 || gain != gain)
+        return (0);
+    invalidate();
+
+    C = L->YCol;
+    C.Type = type;
+    C.Gain = gain;
+    C.Offset = offset;
+    return (retype(L, &L->XCol, &C));
+}
+
+/************************************************************************
+*                          ystore
+* Return how a line stores its Y values
+************************************************************************/
+int Fl_PlotXY::ystore(int line)
+{
+    Fl_PlotXY_Line *L;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::ystore(int)\n");
+
+    if ((L = getselected(line)) == NULL)
+        return (-1); /* Get Data */
+
+    return (L->YCol.Type);
+}
+
+/************************************************************************
+*                          ystorescale
+* Return the gain and offset of a line's integer Y values
+************************************************************************/
+int Fl_PlotXY::ystorescale(int line, double *gain, double *offset)
+{
+    Fl_PlotXY_Line *L;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::ystorescale(int,double*,double*)\n");
+
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Get Data */
+
+    *gain = L->YCol.Gain;
+    *offset = L->YCol.Offset;
+    return (1);
+}
+
+/************************************************************************
+*                          retype
+* Change the storage types of a line, converting the points it has
+************************************************************************/
+int Fl_PlotXY::retype(Fl_PlotXY_Line *L, const Fl_PlotXY_Column *X, const Fl_PlotXY_Column *Y)
+{
+    int columnar;
+
+    /* Anything but doubles has to be columnar */
+    columnar = L->Columnar || X->Type != FL_PLOTXY_DOUBLE || Y->Type != FL_PLOTXY_DOUBLE;
+
+    /* An attached buffer can only be scaled differently */
+    if (L->External)
+    {
+        if (X->Type != L->XCol.Type || Y->Type != L->YCol.Type)
+            return (0);
+        L->XCol.Gain = X->Gain;
+        L->XCol.Offset = X->Offset;
+        L->YCol.Gain = Y->Gain;
+        L->YCol.Offset = Y->Offset;
+        L->BoundsValid = 0;
+        if (L->Pyramid != NULL)
+        {
+            memset(L->Pyramid->Size, 0, sizeof(L->Pyramid->Size));
+            pyramid_add(L, 0);
+        }
+        return (1);
+    }
+
+    /* Nothing stored yet - just change how it will be */
+    if (L->DataCapacity == 0)
+    {
+        L->XCol.Type = X->Type;
+        L->XCol.Gain = X->Gain;
+        L->XCol.Offset = X->Offset;
+        L->YCol.Type = Y->Type;
+        L->YCol.Gain = Y->Gain;
+        L->YCol.Offset = Y->Offset;
+        L->Columnar = columnar;
+        line_cols(L);
+        return (1);
+    }
+
+    /* Same capacity, a ring buffer comes out unwrapped */
+    if (!store_move(L, L->DataCapacity, columnar, L->Segmented, 0, L->DataSize, X, Y))
+    {
+        if (P_DEBUG > 0)
+            printf(" ERROR: Not Enough Space\n");
+        return (0);
+    }
+
+    /* Values may have moved to the nearest step or been renumbered */
+    L->BoundsValid = 0;
+    if (L->Pyramid != NULL)
+    {
+        memset(L->Pyramid->Size, 0, sizeof(L->Pyramid->Size));
+        pyramid_add(L, 0);
+    }
+
+    return (1);
+}
+
+/************************************************************************
+*                          attach
+* Show a buffer owned by the caller as the line's points
+************************************************************************/
+int Fl_PlotXY::attach(int line, unsigned long int n, const void *X, int xtype, int xstride,
+                      const void *Y, int ytype, int ystride, void (*release)(void *), void *arg)
+{
+    Fl_PlotXY_Line *L;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::attach(int,unsigned long int,const void*,int,int,const void*,int,int,void(*)(void*),void*)\n");
+
+    if ((L = getselected(line)) == NULL || Y == NULL)
+        return (0); /* Get Data */
+
+    if ((X != NULL && (xtype < FL_PLOTXY_DOUBLE || xtype > FL_PLOTXY_INT32)) ||
+        ytype < FL_PLOTXY_DOUBLE || ytype > FL_PLOTXY_INT32 || xstride < 0 || ystride < 0)
+        return (0);
+
+    /* Let go of the points, or buffer, there now */
+    clear(line);
+    store_free(L);
+    L->MaxPoints = 0;
+
+    if (X == NULL)
+    {
+        /* Sample numbers, keeping x0 and dx if already uniform */
+        if (L->XCol.Type != FL_PLOTXY_UNIFORM)
+        {
+            L->XCol.Type = FL_PLOTXY_UNIFORM;
+            L->XCol.Gain = 1.0;
+            L->XCol.Offset = 0.0;
+        }
+        L->XCol.Data = (char *)Y;
+        L->XCol.Stride = 0;
+    }
+    else
+    {
+        L->XCol.Type = xtype;
+        L->XCol.Data = (char *)X;
+        L->XCol.Stride = xstride ? xstride : col_size(xtype);
+    }
+    L->YCol.Type = ytype;
+    L->YCol.Data = (char *)Y;
+    L->YCol.Stride = ystride ? ystride : col_size(ytype);
+
+    /* Owned points taken on after detach are columnar if need be */
+    L->Columnar = L->Columnar || L->XCol.Type != FL_PLOTXY_DOUBLE || ytype != FL_PLOTXY_DOUBLE;
+
+    L->External = 1;
+    L->Release = release;
+    L->ReleaseArg = arg;
+    line_cols(L);
+
+    /* Take in the points */
+    return (attach(line, n));
+}
+
+/************************************************************************
+*                          attach
+* The attached buffer now holds n points
+************************************************************************/
+int Fl_PlotXY::attach(int line, unsigned long int n)
+{
+    Fl_PlotXY_Line *L;
+    unsigned long int first;
+    double mn, mx;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::attach(int,unsigned long int)\n");
+
+    if ((L = getselected(line)) == NULL || !L->External || L->Group != NULL)
+        return (0); /* Get Data */
+
+    if (n < L->DataSize)
+    {
+        /* Fewer - start again */
+        invalidate();
+        L->DataSize = 0;
+        L->BoundsValid = 0;
+        if (L->Pyramid != NULL)
+            memset(L->Pyramid->Size, 0, sizeof(L->Pyramid->Size));
+    }
+
+    first = L->DataSize;
+    L->DataCapacity = n;
+    L->DataSize = n;
+    L->Appended += n - first;
+
+    /* Widen the range by the new points, or leave it to minmax to scan */
+    if (first == 0)
+        L->BoundsValid = 0;
+    else if (L->BoundsValid && n > first)
+    {
+        mn = mx = col_x(L, first);
+        col_scan(&L->XCol, first, n - first, &mn, &mx);
+        if (mn < L->DataXmin)
+            L->DataXmin = mn;
+        if (mx > L->DataXmax)
+            L->DataXmax = mx;
+        mn = mx = col_y(L, first);
+        col_scan(&L->YCol, first, n - first, &mn, &mx);
+        if (mn < L->DataYmin)
+            L->DataYmin = mn;
+        if (mx > L->DataYmax)
+            L->DataYmax = mx;
+    }
+    pyramid_add(L, first);
+
+    return (1);
+}
+
+/************************************************************************
+*                          detach
+* Let go of the caller's buffer, leaving the line empty
+************************************************************************/
+int Fl_PlotXY::detach(int line)
+{
+    Fl_PlotXY_Line *L;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::detach(int)\n");
+
+    if ((L = getselected(line)) == NULL || !L->External || L->Group != NULL)
+        return (0); /* Get Data */
+
+    clear(line);
+    return (1);
+}
+
+/************************************************************************
+*                          attached
+* Check if the line shows the caller's buffer
+************************************************************************/
+int Fl_PlotXY::attached(int line)
+{
+    Fl_PlotXY_Line *L;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::attached(int)\n");
+
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Get Data */
+
+    return (L->External && L->Group == NULL);
+}
+
+/************************************************************************
+*                          group_free
+************************************************************************/
+static void group_free(Fl_PlotXY_Group *G)
+{
+    free(G->Line);
+    pool_free(G->Pool, G->X);
+    free(G->XPix);
+    free(G->XPixDone);
+    free(G);
+}
+
+/************************************************************************
+*                          group_grow
+* Make room for cap rows - X and the Y of every line.
+* Lines grown before a failure keep their room for the next try.
+************************************************************************/
+static int group_grow(Fl_PlotXY_Group *G, unsigned long int cap)
+{
+    Fl_PlotXY_Line *L;
+    double *X;
+    char *Y;
+    int count;
+
+    if (cap > (unsigned long int)-1 / sizeof(double))
+        return (0); /* Would overflow */
+
+    if ((X = (double *)pool_realloc(G->Pool, G->X, cap * sizeof(double))) == NULL)
+        return (0);
+    G->X = X;
+
+    for (count = 0; count < G->Count; count++)
+    {
+        if ((L = G->Line[count]) == NULL)
+            continue;
+
+        L->XCol.Data = (char *)X;
+        if (L->DataCapacity >= cap)
+            continue;
+
+        if ((Y = (char *)pool_realloc(L->Pool, L->Cols, cap * col_size(L->YCol.Type))) == NULL)
+            return (0);
+        L->Cols = Y;
+        L->YCol.Data = Y;
+        L->DataCapacity = cap;
+    }
+
+    G->Capacity = cap;
+    return (1);
+}
+
+/************************************************************************
+*                          newgroup
+* Make lines share one X column
+************************************************************************/
+int Fl_PlotXY::newgroup(int n, const int *lines)
+{
+    Fl_PlotXY_Group *G, **Slots;
+    Fl_PlotXY_Line *L;
+    int count, g;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::newgroup(int,const int*)\n");
+
+    if (n <= 0 || lines == NULL)
+        return (-1);
+
+    if ((G = (Fl_PlotXY_Group *)calloc(1, sizeof(Fl_PlotXY_Group))) == NULL)
+        return (-1);
+    if ((G->Line = (Fl_PlotXY_Line **)malloc(n * sizeof(Fl_PlotXY_Line *))) == NULL)
+    {
+        group_free(G);
+        return (-1);
+    }
+
+    /* Only empty lines of their own, each once */
+    for (count = 0; count < n; count++)
+    {
+        if ((L = getselected(lines[count])) == NULL || L->DataSize != 0 || L->MaxPoints != 0 || L->External)
+            break;
+        for (g = 0; g < count && G->Line[g] != L; g++)
+            ;
+        if (g < count)
+            break;
+        G->Line[count] = L;
+    }
+
+    /* Free group number, or one more */
+    for (g = 0; g < GroupSlots && Groups[g] != NULL; g++)
+        ;
+    if (count == n && g == GroupSlots)
+    {
+        if ((Slots = (Fl_PlotXY_Group **)realloc(Groups, (GroupSlots + 1) * sizeof(Fl_PlotXY_Group *))) != NULL)
+        {
+            Groups = Slots;
+            Groups[GroupSlots++] = NULL;
+        }
+    }
+    if (count < n || g == GroupSlots)
+    {
+        group_free(G);
+        return (-1);
+    }
+
+    G->Number = g;
+    G->Count = G->Members = n;
+    G->Pool = &Pool;
+    Groups[g] = G;
+
+    /* The lines show the group's X, doubles, and keep their Y type */
+    for (count = 0; count < n; count++)
+    {
+        L = G->Line[count];
+        store_free(L);
+        L->Group = G;
+        L->External = 1;
+        L->Columnar = 1;
+        L->DataStart = 0;
+        L->BoundsValid = 0;
+        L->XCol.Type = FL_PLOTXY_DOUBLE;
+        L->XCol.Gain = 1.0;
+        L->XCol.Offset = 0.0;
+        L->XCol.Base = 0;
+        L->XCol.Stride = sizeof(double);
+        L->YCol.Stride = col_size(L->YCol.Type);
+    }
+
+    return (g);
+}
+
+/************************************************************************
+*                          add_row
+* Add an X and a Y for each line of a group
+************************************************************************/
+int Fl_PlotXY::add_row(int group, double x, const double *ys)
+{
+    Fl_PlotXY_Group *G;
+    Fl_PlotXY_Line *L;
+    int count;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::add_row(int,double,const double*)\n");
+
+    if (group < 0 || group >= GroupSlots || (G = Groups[group]) == NULL || ys == NULL)
+        return (0); /* Get Data */
+
+    /* Allocate More memory when full - doubling, or just one more */
+    if (G->Size == G->Capacity && !group_grow(G, G->Capacity ? 2 * G->Capacity : 16) &&
+        !group_grow(G, G->Size + 1))
+        return (0); /* Not Enough Space!! */
+
+    /* X once, then the Y of each line */
+    G->X[G->Size] = x;
+    for (count = 0; count < G->Count; count++)
+    {
+        if ((L = G->Line[count]) == NULL)
+            continue;
+
+        col_set(&L->YCol, G->Size, ys[count]);
+        bounds_add(L, x, col_y(L, G->Size));
+
+        L->DataSize++;
+        L->Appended++;
+        pyramid_add(L, L->DataSize - 1);
+    }
+    G->Size++;
+
+    return (1);
+}
+
+/************************************************************************
+*                          add_rows
+* Add a block of rows to a group, a line at a time
+************************************************************************/
+int Fl_PlotXY::add_rows(int group, const double *x, const double *const *ys, unsigned long int n)
+{
+    Fl_PlotXY_Group *G;
+    Fl_PlotXY_Line *L;
+    double xmn = 0.0, xmx = 0.0, ymn, ymx;
+    int count, scanned = 0;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::add_rows(int,const double*,const double*const*,unsigned long int)\n");
+
+    if (group < 0 || group >= GroupSlots || (G = Groups[group]) == NULL || x == NULL || ys == NULL)
+        return (0); /* Get Data */
+
+    if (n == 0)
+        return (1);
+
+    /* Room for the whole block in one go - doubling, or just enough */
+    if (n > (unsigned long int)-1 - G->Size)
+        return (0);
+    if (G->Size + n > G->Capacity && (G->Capacity > (unsigned long int)-1 / 2 || 2 * G->Capacity < G->Size + n ||
+                                      !group_grow(G, 2 * G->Capacity)) &&
+        !group_grow(G, G->Size + n))
+        return (0); /* Not Enough Space!! */
+
+    /* X once, then the Y column of each line */
+    memcpy(G->X + G->Size, x, n * sizeof(double));
+    for (count = 0; count < G->Count; count++)
+    {
+        if ((L = G->Line[count]) == NULL)
+            continue;
+
+        col_put(&L->YCol, G->Size, ys[count], 1, n);
+
+        /* Widen the range by the corners of the block - X is scanned once */
+        if (L->BoundsValid || L->DataSize == 0)
+        {
+            if (!scanned)
+            {
+                xmn = xmx = G->X[G->Size];
+                col_scan(&L->XCol, G->Size, n, &xmn, &xmx);
+                scanned = 1;
+            }
+            ymn = ymx = col_y(L, G->Size);
+            col_scan(&L->YCol, G->Size, n, &ymn, &ymx);
+            bounds_add(L, xmn, ymn);
+            bounds_add(L, xmx, ymx);
+        }
+        L->DataSize += n;
+        L->Appended += n;
+        pyramid_add(L, G->Size);
+    }
+    G->Size += n;
+
+    return (1);
+}
+
+/************************************************************************
+*                          removegroup
+* Split a group up, each line with its own copy of X
+************************************************************************/
+int Fl_PlotXY::removegroup(int group)
+{
+    Fl_PlotXY_Group *G;
+    Fl_PlotXY_Line *L;
+    int count, ok = 1;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::removegroup(int)\n");
+
+    if (group < 0 || group >= GroupSlots || (G = Groups[group]) == NULL)
+        return (0); /* Get Data */
+
+    for (count = 0; count < G->Count; count++)
+    {
+        if ((L = G->Line[count]) == NULL)
+            continue;
+
+        /* Own columnar storage, just big enough */
+        L->Group = NULL;
+        L->External = 0;
+        if (!store_move(L, L->DataSize, 1, L->Segmented, 0, L->DataSize, &L->XCol, &L->YCol))
+        {
+            ok = 0;
+            clear(L->LineNumber);
+        }
+    }
+
+    Groups[group] = NULL;
+    group_free(G);
+
+    return (ok);
+}
+
+/************************************************************************
+*                          group_leave
+* Take a line out of its group
+************************************************************************/
+void Fl_PlotXY::group_leave(Fl_PlotXY_Line *L)
+{
+    Fl_PlotXY_Group *G = L->Group;
+    int count;
+
+    for (count = 0; count < G->Count; count++)
+    {
+        if (G->Line[count] == L)
+            G->Line[count] = NULL;
+    }
+    L->Group = NULL;
+
+    /* Gone with its last line */
+    if (--G->Members == 0)
+    {
+        Groups[G->Number] = NULL;
+        group_free(G);
+    }
+}
+
+/************************************************************************
+*                          linegroup
+* Gets the group of a line
+************************************************************************/
+int Fl_PlotXY::linegroup(int line)
+{
+    Fl_PlotXY_Line *L;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::linegroup(int)\n");
+
+    if ((L = getselected(line)) == NULL || L->Group == NULL)
+        return (-1); /* Get Data */
+
+    return (L->Group->Number);
+}
+
+/************************************************************************
+*                          pyramid
+* Build or free the Min/Max pyramid of a line
+************************************************************************/
+int Fl_PlotXY::pyramid(int line, int on)
+{
+    Fl_PlotXY_Line *L;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::pyramid(int,int)\n");
+
+    if ((L = getselected(line)) == NULL)
+        return 0; /* Get Data */
+
+    if (!on)
+    {
+        pyramid_free(L);
+        return (1);
+    }
+
+    if (L->Pyramid != NULL)
+        return (1); /* Already kept */
+
+    if (L->MaxPoints != 0)
+        return (0); /* Not for ring buffers */
+
+    if ((L->Pyramid = (Fl_PlotXY_Pyramid *)calloc(1, sizeof(Fl_PlotXY_Pyramid))) == NULL)
+        return (0);
+
+    /* Take in all the points there already */
+    pyramid_add(L, 0);
+
+    return (L->Pyramid != NULL);
+}
+
+/************************************************************************
+*                          pyramid
+* Check if line keeps a pyramid
+************************************************************************/
+int Fl_PlotXY::pyramid(int line)
+{
+    Fl_PlotXY_Line *L;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::pyramid(int)\n");
+
+    if ((L = getselected(line)) == NULL)
+        return 0; /* Get Data */
+
+    return (L->Pyramid != NULL);
+}
+
+/************************************************************************
+*                          linecolor
+* Set Line Colour
+************************************************************************/
+int Fl_PlotXY::linecolor(int line, Fl_Color C)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::linecolor(int line,Fl_Color C)\n");
+    if ((L = getselected(line)) == NULL)
+        return 0; /* Get Data */
+    invalidate();
+    
+    L->C = C;     /* Set Colour */
+    return (1);
+}
+
+/************************************************************************
+*                          linecolor
+* Return Line colour
+************************************************************************/
+Fl_Color Fl_PlotXY::linecolor(int line)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::linecolor(int line)\n");
+    if ((L = getselected(line)) == NULL)
+        return (FL_BLACK); /* Get Data */
+    return (L->C);
+}
+
+/************************************************************************
+*                          setrange
+* Set lines range
+************************************************************************/
+int Fl_PlotXY::setrange(int line, double Xmin, double Ymin, double Xmax, double Ymax)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::setrange(int line,double Xmin,double Ymin,double Xmax,double Ymax)\n");
+    if ((L = getselected(line)) == NULL)
+        return 0; /* Get Data */
+    invalidate();
+
+    /* Set the Min and Max values - check for correct way around */
+    if (Xmin < Xmax)
+    {
+        L->Xmin = Xmin;
+        L->Xmax = Xmax;
+    }
+    else
+    {
+        L->Xmin = Xmax;
+        L->Xmax = Xmin;
+    }
+
+    if (Ymin < Ymax)
+    {
+        L->Ymin = Ymin;
+        L->Ymax = Ymax;
+    }
+    else
+    {
+        L->Ymin = Ymax;
+        L->Ymax = Ymin;
+    }
+
+    L->StripSpan = L->Xmax - L->Xmin;
+    return (1);
+}
+
+/************************************************************************
+*                          getrange
+* Returns range from current mode
+************************************************************************/
+int Fl_PlotXY::getrange(int line, double *Xmin, double *Ymin, double *Xmax, double *Ymax)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::getrange(int line, double* X,double* Y,double* X2,double* Y2)\n");
+
+    if ((L = getselected(line)) == NULL)
+        return 0; /* Get Data */
+
+    switch (L->ScaleMode)
+    {
+    default:
+    case FL_PLOTXY_AUTO:
+        minmax(L);
+        *Xmin = MinX;
+        *Xmax = MaxX;
+        *Ymin = MinY;
+        *Ymax = MaxY;
+        break;
+
+    case FL_PLOTXY_STRIP:
+        strip_view(L, PW);
+        /* Fall through - the range is now fixed */
+
+    case FL_PLOTXY_FIXED:
+        *Xmin = L->Xmin;
+        *Xmax = L->Xmax;
+        *Ymin = L->Ymin;
+        *Ymax = L->Ymax;
+        break;
+    }
+    return (1);
+}
+
+/************************************************************************
+*                          scalemode
+*Sets the scale mode
+************************************************************************/
+int Fl_PlotXY::scalemode(int line, int mode)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::scalemode(int line, int mode)\n");
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Get Data */
+    invalidate();
+    L->ScaleMode = mode;
+    return (1);
+}
+
+/************************************************************************
+*                          linemode
+*Sets the line mode
+************************************************************************/
+int Fl_PlotXY::drawmode(int line, int mode)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::drawmode(int line , int mode)\n");
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Get Data */
+    invalidate();
+    L->DrawMode = mode;
+    return (1);
+}
+
+/************************************************************************
+*                          clear
+*Clear the lines data
+************************************************************************/
+void Fl_PlotXY::clear(int line)
+{
+    Fl_PlotXY_Line *L;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::clear(int line)\n");
+    if ((L = getselected(line)) == NULL)
+        return; /* Check for valid line */
+    invalidate();
+
+    if (P_DEBUG > 1)
+        printf(" Freeing Memory\n");
+
+    L->DataSize = 0;    /* Set Data size to 0 */
+    L->DataStart = 0;   /* Ring starts over   */
+    L->BoundsValid = 0; /* No data range      */
+    L->XCol.Base = 0;   /* Uniform X from x0  */
+    line_cols(L);
+
+    if (L->Pyramid != NULL)
+        memset(L->Pyramid->Size, 0, sizeof(L->Pyramid->Size));
+
+    /* Ring buffers keep their storage - unless it is in chunks */
+    if (L->MaxPoints != 0 && !L->Segmented)
+        return;
+
+    /* A line in a group stops showing its X */
+    if (L->Group != NULL)
+        group_leave(L);
+
+    /* Free the Memory Used */
+    store_free(L);
+}
+
+/************************************************************************
+*                          clearall
+* Clear all lines data
+************************************************************************/
+void Fl_PlotXY::clearall(void)
+{
+    int count;
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::clearall(void)\n");
+
+    for (count = 0; count < LineSlots; count++)
+    {
+        clear(count);
+    }
+}
+
+/************************************************************************
+*                          remove
+* Remove individual line
+************************************************************************/
+void Fl_PlotXY::remove(int line)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::remove(int line)\n");
+    if ((L = getselected(line)) == NULL)
+        return; /* Check for valid line */
+    invalidate();
+
+    /* Free any memory used */
+    clear(line);
+    store_free(L);
+    pyramid_free(L);
+
+    /* Next line here starts as interleaved doubles in one block */
+    L->Columnar = 0;
+    L->Segmented = 0;
+    L->XCol.Type = L->YCol.Type = FL_PLOTXY_DOUBLE;
+    L->XCol.Gain = L->YCol.Gain = 1.0;
+    L->XCol.Offset = L->YCol.Offset = 0.0;
+    L->XCol.Base = 0;
+    line_cols(L);
+
+    /* Indicate Not used any more, ready for newline to hand out */
+    showlist(L, 0);               /* Turn Line Display OFF     */
+    L->NextFree = FreeLine;
+    FreeLine = L->LineNumber;
+    L->LineNumber = -1;
+    L->DataSize = 0;              /* Set Data size to 0        */
+    L->MaxPoints = 0;             /* Grow without limit        */
+    L->DrawMode = FL_PLOTXY_LINE; /* Line Drawing Mode         */
+    L->ScaleMode = FL_PLOTXY_AUTO;
+    L->Xmin = 0.0;
+    L->Xmax = 0.0;
+    L->Ymin = 0.0;
+    L->Ymax = 0.0;
+    L->title = NULL; /* Pointer to string array for title */
+    L->C = FL_BLACK; /* Line and title Colour             */
+}
+
+/************************************************************************
+*                          removeall
+* Remove All Lines
+************************************************************************/
+void Fl_PlotXY::removeall(void)
+{
+    int count;
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::removeall(void)\n");
+
+    /* Last removed is handed out first - line 0 comes back first */
+    for (count = LineSlots - 1; count >= 0; count--)
+    {
+        remove(count);
+    }
+}
+
+/************************************************************************
+*                          change
+* Change value of a point
+************************************************************************/
+int Fl_PlotXY::change(int line, unsigned long int p, double X, double Y)
+{
+    Fl_PlotXY_Line *L;
+    unsigned long int q;
+    double OX, OY;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::change(int,unsigned long int,double,double)\n");
+
+    /* Get Data */
+    if ((L = getselected(line)) == NULL || L->External)
+        return 0; /* Data Set not avaliable */
+    invalidate();
+
+    /* Check  if change is in range */
+    if (p >= L->DataSize)
+        return 0; /* Out of range */
+
+    if (P_DEBUG > 1)
+        printf(" Changing Data\n");
+
+    /* Change the Data */
+    q = line_phys(L, p);
+    OX = col_x(L, q);
+    OY = col_y(L, q);
+    col_set(&L->XCol, q, X);
+    col_set(&L->YCol, q, Y);
+    X = col_x(L, q);
+    Y = col_y(L, q);
+
+    /* Moving a point off the edge of the range means finding the range again */
+    if (L->BoundsValid &&
+        ((OX == L->DataXmin && X > OX) || (OX == L->DataXmax && X < OX) ||
+         (OY == L->DataYmin && Y > OY) || (OY == L->DataYmax && Y < OY)))
+        L->BoundsValid = 0;
+    bounds_add(L, X, Y);
+    pyramid_fix(L, p);
+
+    if (P_DEBUG > 1)
+        printf(" Done\n");
+    return (1);
+}
+
+/************************************************************************
+*                          read
+* Read value of a point
+************************************************************************/
+int Fl_PlotXY::read(int line, unsigned long int p, double *X, double *Y)
+{
+    Fl_PlotXY_Line *L;
+
+    *X = 0.0;
+    *Y = 0.0;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::read(int,unsigned long int,double*,double*)\n");
+
+    /* Get Data */
+    if ((L = getselected(line)) == NULL)
+        return 0; /* Data Set not avaliable */
+
+    /* Check  if change is in range */
+    if (p >= L->DataSize)
+        return 0; /* Out of range */
+
+    if (P_DEBUG > 1)
+        printf(" Reading Data\n");
+
+    p = line_phys(L, p);
+    *X = col_x(L, p);
+    *Y = col_y(L, p);
+
+    return (1);
+}
+
+/************************************************************************
+*                          points
+* Read-only access to all points of a line
+************************************************************************/
+const Fl_PlotXY_Data *Fl_PlotXY::points(int line, unsigned long int *n)
+{
+    return (points(line, 0, (unsigned long int)-1, n));
+}
+
+/************************************************************************
+*                          points
+* Read-only access to points [first,last) of a line
+************************************************************************/
+const Fl_PlotXY_Data *Fl_PlotXY::points(int line, unsigned long int first, unsigned long int last, unsigned long int *n)
+{
+    Fl_PlotXY_Line *L;
+    unsigned long int p;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::points(int,unsigned long int,unsigned long int,unsigned long int*)\n");
+
+    *n = 0;
+
+    /* Get Data */
+    if ((L = getselected(line)) == NULL || L->Columnar || L->External)
+        return (NULL); /* Data Set not avaliable */
+
+    if (last > L->DataSize)
+        last = L->DataSize;
+    if (first >= last)
+        return (NULL); /* Out of range */
+
+    *n = line_run(L, first, last, &p);
+    return ((const Fl_PlotXY_Data *)col_at(&L->XCol, p));
+}
+
+/************************************************************************
+*                          columns
+* Read-only access to X and Y values of points [first,last) of a line
+************************************************************************/
+unsigned long int Fl_PlotXY::columns(int line, unsigned long int first, unsigned long int last,
+                                     const double **X, const double **Y, int *step)
+{
+    Fl_PlotXY_Line *L;
+    unsigned long int n, p;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::columns(int,unsigned long int,unsigned long int,const double**,const double**,int*)\n");
+
+    *X = *Y = NULL;
+    *step = 0;
+
+    /* Get Data */
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Data Set not avaliable */
+
+    if (L->XCol.Type != FL_PLOTXY_DOUBLE || L->YCol.Type != FL_PLOTXY_DOUBLE)
+        return (0); /* Not stored as doubles */
+
+    if (L->XCol.Stride != L->YCol.Stride || L->XCol.Stride % sizeof(double) != 0)
+        return (0); /* Attached buffer that can not be stepped through as doubles */
+
+    if (last > L->DataSize)
+        last = L->DataSize;
+    if (first >= last)
+        return (0); /* Out of range */
+
+    n = line_run(L, first, last, &p);
+    *X = (const double *)col_at(&L->XCol, p);
+    *Y = (const double *)col_at(&L->YCol, p);
+    *step = L->XCol.Stride / sizeof(double);
+    return (n);
+}
+
+/************************************************************************
+*                          datasize
+*Return current Data position
+************************************************************************/
+unsigned long int Fl_PlotXY::datasize(int line)
+{
+    Fl_PlotXY_Line *L;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::datasize(int)\n");
+
+    /* Get Data */
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Data Set not avaliable */
+
+    if (P_DEBUG > 1)
+        printf(" DataSize=%ld\n", L->DataSize);
+
+    return (L->DataSize);
+}
+
+/************************************************************************
+*                          used
+* Indicates if line number is in use
+************************************************************************/
+int Fl_PlotXY::used(int line)
+{
+    Fl_PlotXY_Line *L;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::used(int)\n");
+    /* Get Data */
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Data Set not avaliable */
+    return (1);
+}
+
+/************************************************************************
+*                          lineshow
+*Turn a line on
+************************************************************************/
+int Fl_PlotXY::lineshow(int line)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::lineshow(int)\n");
+    /* Get Data */
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Data Set not avaliable */
+    invalidate();
+
+    showlist(L, 1);
+
+    return (1);
+}
+
+/************************************************************************
+*                          linehide
+* turn Line off
+************************************************************************/
+int Fl_PlotXY::linehide(int line)
+{
+    Fl_PlotXY_Line *L;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::linehide(int)\n");
+    /* Get Data */
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Data Set not avaliable */
+    invalidate();
+
+    showlist(L, 0);
+
+    return (1);
+}
+
+/************************************************************************
+*                          linevisible
+*Check if line is currently visible
+************************************************************************/
+int Fl_PlotXY::linevisible(int line)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::linevisible(int)\n");
+    /* Get Data */
+    if ((L = getselected(line)) == NULL)
+        return (-1); /* Data Set not avaliable */
+
+    return (L->Displayed);
+}
+
+/************************************************************************
+*                          xmarkon(int)
+* check if X marks are On or Off
+************************************************************************/
+int Fl_PlotXY::xmarkon(int line)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::xmarkon(int)\n");
+    /* Get Data */
+    if ((L = getselected(line)) == NULL)
+        return (-1); /* Data Set not avaliable */
+
+    return (L->XMark);
+}
+
+/************************************************************************
+*                            xmarkon(int,int)
+*Turn X marks on or Off
+************************************************************************/
+int Fl_PlotXY::xmarkon(int line, int mode)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::xmarkon(int,int)\n");
+    /* Get Data */
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Data Set not avaliable */
+    invalidate();
+
+    L->XMark = mode;
+
+    return (1);
+}
+
+/************************************************************************
+*                          xmarkstep(int,double)
+* Set the X mark step size
+************************************************************************/
+int Fl_PlotXY::xmarkstep(int line, double size)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::xmarkstep(int,double)\n");
+    /* Get Data */
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Data Set not avaliable */
+    invalidate();
+
+    L->XMarkSize = size;
+
+    return (1);
+}
+
+/************************************************************************
+*                          xmarklabel(int,const char*)
+* Set the X Axis Label
+************************************************************************/
+int Fl_PlotXY::xmarklabel(int line, const char *xlabel)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::xmarklabel(int,const char*)\n");
+    /* Get Data */
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Data Set not avaliable */
+    invalidate();
+
+    L->XLabel = xlabel;
+
+    return (1);
+}
+
+/************************************************************************
+*                          const char* xmarklabel(int)
+*Return the X Axis Label
+************************************************************************/
+const char *Fl_PlotXY::xmarklabel(int line)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::xmarklabel(int,const char*)\n");
+    /* Get Data */
+    if ((L = getselected(line)) == NULL)
+        return NULL; /* Data Set not avaliable */
+
+    return (L->XLabel);
+}
+
+/************************************************************************
+*                     xvaltype(int,int)
+* Set the X value type (time, date etc)
+************************************************************************/
+int Fl_PlotXY::xvaltype(int line, int type)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::xvaltype(int,int)\n");
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Data Set not avaliable */
+    invalidate();
+
+    L->XValType = type;
+
+    return (1);
+}
+
+/************************************************************************
+*                     xvaltype(int,int)
+* return X value type (time, date etc)
+************************************************************************/
+int Fl_PlotXY::xvaltype(int line)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::xvaltype(int,int)\n");
+    if ((L = getselected(line)) == NULL)
+        return (-1); /* Data Set not avaliable */
+
+    return (L->XValType);
+}
+
+/************************************************************************
+*                          ymarkon(int)
+*check if Y marks are On or Off
+************************************************************************/
+int Fl_PlotXY::ymarkon(int line)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::ymarkon(int)\n");
+    /* Get Data */
+    if ((L = getselected(line)) == NULL)
+        return (-1); /* Data Set not avaliable */
+
+    return (L->YMark);
+}
+
+/************************************************************************
+*                          ymarkon(int,int)
+*Turn Y marks on or Off
+************************************************************************/
+int Fl_PlotXY::ymarkon(int line, int mode)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::ymarkon(int,int)\n");
+    /* Get Data */
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Data Set not avaliable */
+    invalidate();
+
+    L->YMark = mode;
+
+    return (1);
+}
+
+/************************************************************************
+*                     ymarkstep(int,double)
+* Set the Y mark step size
+************************************************************************/
+int Fl_PlotXY::ymarkstep(int line, double size)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::ymarkstep(int,double)\n");
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Data Set not avaliable */
+    invalidate();
+
+    L->YMarkSize = size;
+
+    return (1);
+}
+
+/************************************************************************
+*                          ymarklabel(int,const char*)
+*Set the Y Axis Label
+************************************************************************/
+int Fl_PlotXY::ymarklabel(int line, const char *ylabel)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::ymarklabel(int,const char*)\n");
+    /* Get Data */
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Data Set not avaliable */
+    invalidate();
+
+    L->YLabel = ylabel;
+
+    return (1);
+}
+
+/************************************************************************
+*                    const char* ymarklabel(int)
+*Return the X Axis Label
+************************************************************************/
+const char *Fl_PlotXY::ymarklabel(int line)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::xmarklabel(int,const char*)\n");
+    /* Get Data */
+    if ((L = getselected(line)) == NULL)
+        return NULL; /* Data Set not avaliable */
+
+    return (L->YLabel);
+}
+
+/************************************************************************
+*                     yvaltype(int,int)
+* Set the Y value type (time, date etc)
+************************************************************************/
+int Fl_PlotXY::yvaltype(int line, int type)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::yvaltype(int,int)\n");
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Data Set not avaliable */
+    invalidate();
+
+    L->YValType = type;
+
+    return (1);
+}
+
+/************************************************************************
+*                     yvaltype(int)
+* Return the Y value type (time, date etc)
+************************************************************************/
+int Fl_PlotXY::yvaltype(int line)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::yvaltype(int,int)\n");
+    if ((L = getselected(line)) == NULL)
+        return (-1); /* Data Set not avaliable */
+
+    return (L->YValType);
+}
+
+/************************************************************************
+*                     xvalformat(int,int,int)
+* Set the X value format  %0whole.0pointslf
+************************************************************************/
+int Fl_PlotXY::xvalformat(int line, int whole, int points)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::xvalformat(int,int,int)\n");
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Data Set not avaliable */
+    invalidate();
+
+    if (whole < 10 && whole >= 0 && points < 10 && points >= 0)
+    {
+        sprintf(L->XValFormat, "%%0%d.0%dlf", whole, points);
+        return (1);
+    }
+    return (0);
+}
+
+/************************************************************************
+*                     yvalformat(int,int,int)
+* Set the Y value format  %0whole.0pointslf
+************************************************************************/
+int Fl_PlotXY::yvalformat(int line, int whole, int points)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::yvalformat(int,int,int)\n");
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Data Set not avaliable */
+    invalidate();
+
+    if (whole < 10 && whole >= 0 && points < 10 && points >= 0)
+    {
+        sprintf(L->YValFormat, "%%0%d.0%dlf", whole, points);
+        return (1);
+    }
+    return (0);
+}
+
+/************************************************************************
+*                linetitle(int , const char* )
+*
+************************************************************************/
+int Fl_PlotXY::linetitle(int line, const char *title)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::yvalformat(int,int,int)\n");
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Data Set not avaliable */
+    invalidate();
+
+    L->title = title;
+    return (1);
+}
+
+/************************************************************************
+*                         linetitle(int)
+*
+************************************************************************/
+const char *Fl_PlotXY::linetitle(int line)
+{
+    Fl_PlotXY_Line *L;
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::yvalformat(int,int,int)\n");
+    if ((L = getselected(line)) == NULL)
+        return (NULL); /* Data Set not avaliable */
+
+    return (L->title);
+}
+
+/************************************************************************
+*                              draw
+* The plot comes from the offscreen cache, drawn again only when
+* something changed, with the overlay drawn on top.
+* Points added since the cache was drawn are drawn onto it when the
+* scales allow, and with FL_PLOTXY_DAMAGE_APPEND only that part of
+* the window is updated.
+************************************************************************/
+void Fl_PlotXY::draw()
+{
+    int X = x(), Y = y();
+    int rx = 0, ry = 0, rw = 0, rh = 0, append = 0, part;
+
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY:: draw()\n");
+
+    if (!CacheEnable)
+    {
+        draw_plot();
+        CacheX = X;
+        CacheY = Y;
+    }
+    else
+    {
+        /* A new size needs a new cache */
+        if (Cache && (CacheW != w() || CacheH != h()))
+        {
+            fl_delete_offscreen(Cache);
+            Cache = 0;
+        }
+        if (!Cache)
+        {
+            Cache = fl_create_offscreen(w(), h());
+            CacheW = w();
+            CacheH = h();
+            CacheValid = 0;
+        }
+
+        /* Widget settings Fl_PlotXY can not see being changed */
+        if (CacheColor != color() || CacheBox != box())
+            CacheValid = 0;
+
+        /* The cache has the widget at 0,0 */
+        PX -= CacheX;
+        PY -= CacheY;
+        CacheX = CacheY = 0;
+
+        if (CacheValid)
+        {
+            /* Carry on from what is already drawn */
+            fl_begin_offscreen(Cache);
+            Fl_Widget::x(0);
+            Fl_Widget::y(0);
+            append = draw_append();
+            Fl_Widget::x(X);
+            Fl_Widget::y(Y);
+            fl_end_offscreen();
+            if (!append)
+                CacheValid = 0;
+        }
+
+        if (!CacheValid)
+        {
+            if (P_DEBUG > 2)
+                printf(" Drawing cache\n");
+
+            /* Draw as if the widget sat at 0,0 of the offscreen */
+            fl_begin_offscreen(Cache);
+            Fl_Widget::x(0);
+            Fl_Widget::y(0);
+            draw_plot();
+            Fl_Widget::x(X);
+            Fl_Widget::y(Y);
+            fl_end_offscreen();
+
+            CacheColor = color();
+            CacheBox = box();
+            CacheValid = 1;
+        }
+
+        if (append == 1 && damage() == FL_PLOTXY_DAMAGE_APPEND)
+        {
+            /* Only the new points need copying, within the plot area */
+            rx = (Poly.X1 > PX) ? Poly.X1 : PX;
+            ry = (Poly.Y1 > PY) ? Poly.Y1 : PY;
+            rw = ((Poly.X2 < PX + PW) ? Poly.X2 : PX + PW) - rx + 1;
+            rh = ((Poly.Y2 < PY + PH) ? Poly.Y2 : PY + PH) - ry + 1;
+        }
+        else
+        {
+            rx = ry = 0;
+            rw = w();
+            rh = h();
+        }
+
+        if (rw > 0 && rh > 0)
+            fl_copy_offscreen(X + rx, Y + ry, rw, rh, Cache, rx, ry);
+    }
+
+    /* Plot area follows the widget around the window */
+    PX += X - CacheX;
+    PY += Y - CacheY;
+    CacheX = X;
+    CacheY = Y;
+
+    /* Only put back what a part copy went over */
+    part = append == 1 && damage() == FL_PLOTXY_DAMAGE_APPEND;
+    if (part)
+    {
+        if (rw <= 0 || rh <= 0)
+            return;
+        fl_push_clip(X + rx, Y + ry, rw, rh);
+    }
+
+    /* Clip the graph only area */
+    fl_push_clip(PX, PY, PW, PH + 1);
+    draw_overlay();
+    fl_pop_clip();
+
+    /* Draw the label last so it is on the TOP */
+    draw_label();
+
+    if (part)
+        fl_pop_clip();
+}
+
+/************************************************************************
+*                          draw_append
+* Draw the points added since the cache was drawn onto the cache.
+* Fails when a line's scale changed or a ring buffer dropped points.
+* FL_PLOTXY_STRIP lines that moved on scroll the traces along instead,
+* then the new points and the X axis are drawn.
+* The line labels go back on top of the new traces, as in draw_plot.
+************************************************************************/
+int Fl_PlotXY::draw_append(void)
+{
+    int count, k = 0, lk, strip = 0, other = 0;
+    unsigned long int from;
+    Fl_PlotXY_Line *L;
+
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY:: draw_append()\n");
+
+    /* Check every line can carry on from the cached plot */
+    for (count = 0; count < ShownCount; count++)
+    {
+        L = LineData[Shown[count]];
+
+        if (L->ScaleMode == FL_PLOTXY_STRIP)
+        {
+            strip_view(L, PW);
+
+            if (L->Ymin != L->DrawnYmin || L->Ymax != L->DrawnYmax)
+                return (0); /* Scale changed */
+
+            /* Pixels moved along since the last draw, the same for all */
+            lk = (int)floor((L->Xmax - L->DrawnXmax) * L->X_Scale + 0.5);
+            if (strip++ == 0)
+                k = lk;
+            else if (lk != k)
+                return (0);
+
+            /* Dropped points are fine when they were off the left */
+            if (L->Appended != 0 && L->DrawnSize + L->Appended != L->DataSize &&
+                col_x(L, line_phys(L, 0)) > L->Xmin)
+                return (0);
+            continue;
+        }
+
+        other++;
+        if (L->Appended == 0)
+            continue;
+
+        if (L->DrawnSize + L->Appended != L->DataSize)
+            return (0); /* Points dropped off the front */
+
+        if (L->ScaleMode != FL_PLOTXY_FIXED)
+            minmax(L);
+
+        if (L->Xmin != L->DrawnXmin || L->Xmax != L->DrawnXmax ||
+            L->Ymin != L->DrawnYmin || L->Ymax != L->DrawnYmax)
+            return (0); /* Scale changed */
+    }
+
+    /* Only strip lines can scroll, and not right off the plot */
+    if (strip && (Strip == 0 || k < 0 || k >= PW || (k > 0 && other)))
+        return (0);
+
+    /* Nothing drawn yet */
+    Poly.X1 = PX + PW + 1;
+    Poly.Y1 = PY + PH + 1;
+    Poly.X2 = PX - 1;
+    Poly.Y2 = PY - 1;
+
+    if (strip)
+    {
+        /* Traces without the line labels, k pixels to the left */
+        fl_copy_offscreen(PX, PY, PW - k, PH + 1, Strip, k, 0);
+        if (k > 0)
+        {
+            if (P_DEBUG > 1)
+                printf(" Scrolling %d pixels\n", k);
+            fl_color(color());
+            fl_rectf(PX + PW - k, PY, k, PH + 1);
+        }
+    }
+
+    /* Clip the graph only area */
+    fl_push_clip(PX, PY, PW, PH + 1);
+
+    for (count = 0; count < ShownCount; count++)
+    {
+        L = LineData[Shown[count]];
+
+        if (L->Appended != 0 && L->YCol.Data != NULL)
+        {
+            if (P_DEBUG > 1)
+                printf(" Line %d: %ld new points\n", L->LineNumber, L->Appended);
+
+            /* Start of the new points, still there after any dropped */
+            from = (L->Appended < L->DataSize) ? L->DataSize - L->Appended : 0;
+
+            switch (L->DrawMode)
+            {
+            default:
+            case FL_PLOTXY_DOT:
+                plot_dot(L, from);
+                break;
+
+            case FL_PLOTXY_LINE:
+                plot_line(L, from);
+                break;
+
+            case FL_PLOTXY_DECIMATE:
+                plot_decimate(L, from);
+                break;
+            }
+        }
+
+        L->DrawnSize = L->DataSize;
+        L->Appended = 0;
+        L->DrawnXmin = L->Xmin;
+        L->DrawnXmax = L->Xmax;
+    }
+
+    fl_pop_clip();
+
+    if (strip)
+        strip_save();
+
+    /* Same clipping as draw_plot */
+    fl_push_clip(x() + 2, y() + 2, w() - 4, h() - 4);
+
+    if (k > 0)
+    {
+        /* Values along the X axis moved with the traces - draw them again */
+        fl_push_clip(x() + 2, PY + PH + 1, w() - 4, y() + h() - 3 - (PY + PH));
+        fl_color(color());
+        fl_rectf(x() + 2, PY + PH + 1, w() - 4, y() + h() - 3 - (PY + PH));
+        for (count = 0; count < ShownCount; count++)
+        {
+            L = LineData[Shown[count]];
+            draw_scales(L);
+            draw_axislabel(L);
+        }
+        fl_pop_clip();
+    }
+
+    /* Line labels back on top */
+    for (count = 0; count < ShownCount; count++)
+        draw_linelabel(LineData[Shown[count]]);
+
+    fl_pop_clip();
+
+    return (k > 0 ? 2 : 1);
+}
+
+/************************************************************************
+*                          strip_save
+* Copy the traces in the cache plot area for FL_PLOTXY_STRIP scrolling
+************************************************************************/
+void Fl_PlotXY::strip_save(void)
+{
+    int count, strip = 0;
+
+    for (count = 0; count < ShownCount; count++)
+    {
+        if (LineData[Shown[count]]->ScaleMode == FL_PLOTXY_STRIP)
+            strip = 1;
+    }
+
+    /* A new plot area size needs a new strip */
+    if (Strip && (!strip || StripW != PW || StripH != PH + 1))
+    {
+        fl_delete_offscreen(Strip);
+        Strip = 0;
+    }
+
+    if (!strip || PW <= 0 || PH < 0)
+        return;
+
+    if (!Strip)
+    {
+        Strip = fl_create_offscreen(PW, PH + 1);
+        StripW = PW;
+        StripH = PH + 1;
+    }
+
+    fl_begin_offscreen(Strip);
+    fl_copy_offscreen(0, 0, PW, PH + 1, Cache, PX, PY);
+    fl_end_offscreen();
+}
+
+/************************************************************************
+*                          draw_overlay
+* Drawn on top of the cached plot every time
+************************************************************************/
+void Fl_PlotXY::draw_overlay(void)
+{
+    Fl_PlotXY_Line *L;
+
+    /* Draw the Vertical Line */
+    if (vlineenable())
+    {
+        if ((L = getselected(vlinesel())) != NULL)
+        {
+            draw_vline(L);
+        }
+    }
+}
+
+/************************************************************************
+*                              draw_plot
+************************************************************************/
+void Fl_PlotXY::draw_plot(void)
+{
+    int count;
+
+    Fl_PlotXY_Line *L;
+
+    Fl_Color col = color();
+    draw_box(box(), col);
+
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY:: draw_plot()\n");
+
+    /* Stop any drawing outside of the boxed area */
+    fl_push_clip(x() + 2, y() + 2, w() - 4, h() - 4);
+
+    /* Calculate the plotable area */
+    calc_plot_area();
+
+    /* Clip the graph only area */
+    fl_push_clip(PX, PY, PW, PH + 1);
+
+    /* Check all lines for drawing */
+    for (count = 0; count < ShownCount; count++)
+    {
+        L = LineData[Shown[count]];
+
+        switch (L->ScaleMode)
+        {
+        default:
+        case FL_PLOTXY_AUTO:
+            if (P_DEBUG > 1)
+                printf(" FL_PLOTXY_AUTO\n");
+            minmax(L);
+            break;
+
+        case FL_PLOTXY_STRIP:
+            if (P_DEBUG > 1)
+                printf(" FL_PLOTXY_STRIP\n");
+            strip_view(L, PW);
+            /* Fall through - the range is now fixed */
+
+        case FL_PLOTXY_FIXED:
+            if (P_DEBUG > 1)
+                printf(" FL_PLOTXY_FIXED\n");
+            MinX = L->Xmin;
+            MaxX = L->Xmax;
+            MinY = L->Ymin;
+            MaxY = L->Ymax;
+            break;
+        }
+
+        if (P_DEBUG > 1)
+            printf(" MaxX=%lf, MaxY=%lf\n MinX=%lf, MinY=%lf\n", MaxX, MaxY, MinX, MinY);
+
+        /* Plot the Graph on the Display */
+        if (L->YCol.Data != NULL)
+        {
+            switch (L->DrawMode)
+            {
+            /* Plot Using Dots */
+            default:
+            case FL_PLOTXY_DOT:
+                plot_dot(L);
+                break;
+
+            /* Plot Using Lines */
+            case FL_PLOTXY_LINE:
+                plot_line(L);
+                break;
+
+            /* Plot Using Lines reduced to the pixel columns */
+            case FL_PLOTXY_DECIMATE:
+                plot_decimate(L);
+                break;
+            }
+        }
+
+        /* What the cache now holds */
+        L->DrawnSize = L->DataSize;
+        L->Appended = 0;
+        L->DrawnXmin = L->Xmin;
+        L->DrawnXmax = L->Xmax;
+        L->DrawnYmin = L->Ymin;
+        L->DrawnYmax = L->Ymax;
+    }
+
+    /* Pop the Graph only area */
+    fl_pop_clip();
+
+    /* Keep the traces for scrolling before labels go over them */
+    if (CacheEnable)
+        strip_save();
+
+    /* Draw the Axis Markings and Labels */
+    for (count = 0; count < ShownCount; count++)
+    {
+        L = LineData[Shown[count]];
+        draw_scales(L);    /* Draw Axis       */
+        draw_axislabel(L); /* Draw Axis Label */
+    }
+
+    /* Draw the Line Labels */
+    for (count = 0; count < ShownCount; count++)
+    {
+        draw_linelabel(LineData[Shown[count]]);
+    }
+
+    /* Pop from the clipped area */
+    fl_pop_clip();
+}
+
+/************************************************************************
+*                           calc_plot_area
+************************************************************************/
+void Fl_PlotXY::calc_plot_area(void)
+{
+    Fl_PlotXY_Line *L;
+    int count;
+    int tx, ty, tw, th, ux, uy, uw, uh;
+    int mw, mh, lh;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::calc_plot_area(void)\n");
+
+    /* Check if using graduations etc
+ *  and calc Plot Area required (Scans ALL Values)*/
+
+    ux = PX = x() + 2;
+    uy = PY = y() + 2;
+    uw = PW = w() - 5;
+    uh = PH = h() - 5;
+
+    if (P_DEBUG > 1)
+        printf(" Basic => PX=%d, PY=%d, PW=%d, PH=%d\n", PX, PY, PW, PH);
+
+    fl_font(AxisFontFace, AxisFontSize);
+
+    mw = 0;
+    lh = 0;
+    fl_measure("H", mw, lh, 1); /* Get Text Height, the same for every line */
+
+    for (count = 0; count < ShownCount; count++)
+    {
+        L = LineData[Shown[count]];
+
+        tx = PX;
+        ty = PY;
+        tw = PW;
+        th = PH;
+
+        if (L->XMark & FL_PLOTXY_MARK_ON)
+        {
+            th -= 10; /* Size of the Marking */
+            if ((L->XMark & FL_PLOTXY_MARK_LABEL) && L->XLabel != NULL)
+                th -= (lh + 2);
+            if (L->XMark & FL_PLOTXY_MARK_VAL)
+                th -= (lh + 2);
+            //if(L->XMark & FL_PLOTXY_MARK_NAME)  tw -= 40;
+        }
+
+        if (L->YMark & FL_PLOTXY_MARK_ON)
+        {
+            tx += 10;
+            tw -= 10;
+            if ((L->YMark & FL_PLOTXY_MARK_LABEL) && L->YLabel != NULL)
+            {
+                mw = 0;
+                mh = 0;
+                fl_measure(L->YLabel, mw, mh, 1);
+                tx += (mh + 2);
+                tw -= (mh + 2);
+            }
+            if (L->YMark & FL_PLOTXY_MARK_VAL)
+            {
+                tx += AxisTextSpaceY;
+                tw -= AxisTextSpaceY;
+            }
+            //if((L->YMark & FL_PLOTXY_MARK_NAME))continue;
+        }
+
+        /* Check for changes to min/max range */
+        if (tx > ux)
+            ux = tx;
+        if (ty > uy)
+            uy = ty;
+        if (tw < uw)
+            uw = tw;
+        if (th < uh)
+            uh = th;
+    }
+
+    /* Set the GRAPH drawing Area */
+    PX = ux;
+    PY = uy;
+    PW = uw;
+    PH = uh;
+
+    if (P_DEBUG > 1)
+        printf(" After => PX=%d, PY=%d, PW=%d, PH=%d\n", PX, PY, PW, PH);
+}
+
+/************************************************************************
+*                           plot_dot
+************************************************************************/
+void Fl_PlotXY::plot_dot(Fl_PlotXY_Line *L, unsigned long int from)
+{
+
+    int xs[FL_PLOTXY_VERTICES], ys[FL_PLOTXY_VERTICES];
+    int count, n;
+    unsigned long int first, last;
+
+    if (P_DEBUG > 3)
+        printf("Fl_PlotXY::plot_dot()\n");
+
+    /* Check for Valid Data */
+    if (L->YCol.Data == NULL)
+        return;
+
+    /* Set up zoom scale etc */
+    setscale(L);
+
+    /* Set Line Colour */
+    fl_color(L->C);
+
+    poly_begin(&Poly, FL_PLOTXY_DOT, PX, PY, PX + PW, PY + PH);
+
+    /* Uniform X - skip straight to the points on the plot */
+    last = L->DataSize;
+    line_visible(L, PW, &from, &last);
+
+    /* Plot the Data - a piece at a time around a ring buffer */
+    for (first = from; first < last; first += n)
+    {
+        n = line_pixels(L, first, last, PX, PY + PH, xs, ys);
+        for (count = 0; count < n; count++)
+            poly_vertex(&Poly, xs[count], ys[count]);
+    }
+    poly_end(&Poly);
+}
+
+/************************************************************************
+*                            plot_line
+************************************************************************/
+void Fl_PlotXY::plot_line(Fl_PlotXY_Line *L, unsigned long int from)
+{
+    int xs[FL_PLOTXY_VERTICES], ys[FL_PLOTXY_VERTICES];
+    int count, n;
+    unsigned long int first, last;
+
+    if (P_DEBUG > 3)
+        printf("Fl_PlotXY::plot_line()\n");
+
+    /* Check for Data */
+    if (L->YCol.Data == NULL || L->DataSize == 0)
+        return;
+
+    /* Set up zoom scale etc */
+    setscale(L);
+
+    /* Set Line Colour */
+    fl_color(L->C);
+
+    poly_begin(&Poly, FL_PLOTXY_LINE, PX, PY, PX + PW, PY + PH);
+
+    /* Join on from the point already drawn */
+    if (from > 0)
+        from--;
+
+    /* Uniform X - skip straight to the points on the plot */
+    last = L->DataSize;
+    line_visible(L, PW, &from, &last);
+
+    /* Plot the Data - a piece at a time around a ring buffer */
+    for (first = from; first < last; first += n)
+    {
+        n = line_pixels(L, first, last, PX, PY + PH, xs, ys);
+        for (count = 0; count < n; count++)
+            poly_vertex(&Poly, xs[count], ys[count]);
+    }
+    poly_end(&Poly);
+}
+
+/************************************************************************
+*                          Decimation
+* plot_decimate builds up one pixel column at a time.
+* All the points landing in a column become a single vertical line
+* from their min to their max, joined to the next column from the
+* last point in the column.
+************************************************************************/
+typedef struct
+{
+    Fl_PlotXY_Polyline *P; /* Where the vertices go          */
+    int col;               /* Current column                 */
+    int cmin, cmax, clast; /* Its min, max and last y        */
+} Fl_PlotXY_Envelope;
+
+/* Draw the column down to its last point */
+static inline void env_flush(Fl_PlotXY_Envelope *E)
+{
+    poly_vertex(E->P, E->col, E->cmin);
+    poly_vertex(E->P, E->col, E->cmax);
+    poly_vertex(E->P, E->col, E->clast);
+}
+
+/* Point (xx,yy) follows on */
+static inline void env_point(Fl_PlotXY_Envelope *E, int xx, int yy)
+{
+    /* Still in the same column - just widen it */
+    if (xx == E->col)
+    {
+        if (yy < E->cmin)
+            E->cmin = yy;
+        if (yy > E->cmax)
+            E->cmax = yy;
+        E->clast = yy;
+        return;
+    }
+
+    /* Finish the column and join it to the next */
+    env_flush(E);
+    poly_vertex(E->P, xx, yy);
+
+    E->col = xx;
+    E->cmin = E->cmax = E->clast = yy;
+}
+
+/* Pixel column and row of point i, the same as line_pixels gives */
+static inline int env_x(const Fl_PlotXY_Line *L, unsigned long int i, int left)
+{
+    return (left + (int)((col_x(L, line_phys(L, i)) + L->X_Left) * L->X_Scale));
+}
+
+static inline int env_y(const Fl_PlotXY_Line *L, unsigned long int i, int bottom)
+{
+    return (bottom - (int)((col_y(L, line_phys(L, i)) + L->Y_Bottom) * L->Y_Scale));
+}
+
+/* Points [first,last) of a uniform X line going up by less than half
+ * a pixel each. The points of each column are worked out from the
+ * sample numbers, then taken in one go from their Y range. */
+static void env_uniform(Fl_PlotXY_Envelope *E, const Fl_PlotXY_Line *L, unsigned long int first, unsigned long int last,
+                        int left, int bottom)
+{
+    const Fl_PlotXY_Column *C = &L->XCol;
+    unsigned long int e;
+    double t, mn, mx;
+    int xx, yy;
+
+    while (first < last)
+    {
+        xx = env_x(L, first, left);
+
+        /* First point past the column - close from the sums, then checked */
+        t = ceil(((xx + 1 - left) / L->X_Scale - L->X_Left - C->Offset) / C->Gain - C->Base);
+        e = !(t > (double)first) ? first + 1 : t >= (double)last ? last : (unsigned long int)t;
+        while (e > first + 1 && env_x(L, e - 1, left) > xx)
+            e--;
+        while (e < last && env_x(L, e, left) <= xx)
+            e++;
+
+        /* In on the first point */
+        env_point(E, xx, env_y(L, first, bottom));
+
+        /* The rest widen the column, out on the last */
+        if (e - first > 1)
+        {
+            mn = mx = col_y(L, line_phys(L, first + 1));
+            line_yrange(L, first + 1, e, &mn, &mx);
+            yy = bottom - (int)((mx + L->Y_Bottom) * L->Y_Scale);
+            if (yy < E->cmin)
+                E->cmin = yy;
+            yy = bottom - (int)((mn + L->Y_Bottom) * L->Y_Scale);
+            if (yy > E->cmax)
+                E->cmax = yy;
+            E->clast = env_y(L, e - 1, bottom);
+        }
+        first = e;
+    }
+}
+
+/************************************************************************
+*                            plot_decimate
+* Same picture as plot_line, drawn one pixel column at a time.
+* With a pyramid, blocks of points landing in one column (or wholly
+* off one side of the plot) are taken in one go from their min/max.
+* Without one, a uniform X line finds each column's points by sums.
+************************************************************************/
+void Fl_PlotXY::plot_decimate(Fl_PlotXY_Line *L, unsigned long int from)
+{
+    int xs[FL_PLOTXY_VERTICES], ys[FL_PLOTXY_VERTICES];
+    int xx, xe, yy, level, shift, count, n;
+    Fl_PlotXY_Envelope E;
+    Fl_PlotXY_Pyramid *P;
+    Fl_PlotXY_Block *B;
+    unsigned long int first, b, last, end;
+
+    if (P_DEBUG > 3)
+        printf("Fl_PlotXY::plot_decimate()\n");
+
+    /* Check for Data */
+    if (L->YCol.Data == NULL || L->DataSize == 0)
+        return;
+
+    /* Set up zoom scale etc */
+    setscale(L);
+
+    /* Set Line Colour */
+    fl_color(L->C);
+
+    poly_begin(&Poly, FL_PLOTXY_LINE, PX, PY, PX + PW, PY + PH);
+
+    /* Join on from the point already drawn */
+    if (from > 0)
+        from--;
+
+    /* Uniform X - skip straight to the points on the plot */
+    end = L->DataSize;
+    line_visible(L, PW, &from, &end);
+    if (from >= end)
+        return;
+
+    /* First Point starts the first column */
+    line_pixels(L, from, from + 1, PX, PY + PH, xs, ys);
+    E.P = &Poly;
+    E.col = xs[0];
+    E.cmin = E.cmax = E.clast = ys[0];
+    poly_vertex(&Poly, E.col, E.clast);
+
+    if ((P = L->Pyramid) == NULL)
+    {
+        if (L->XCol.Type == FL_PLOTXY_UNIFORM && L->XCol.Gain > 0.0 && L->XCol.Gain * L->X_Scale < 0.5)
+        {
+            /* Uniform X, several points a column - a column at a time */
+            env_uniform(&E, L, from + 1, end, PX, PY + PH);
+        }
+        else
+        {
+            /* Plot the Data - a piece at a time around a ring buffer */
+            for (first = from + 1; first < end; first += n)
+            {
+                n = line_pixels(L, first, end, PX, PY + PH, xs, ys);
+                for (count = 0; count < n; count++)
+                    env_point(&E, xs[count], ys[count]);
+            }
+        }
+        env_flush(&E);
+        poly_end(&Poly);
+        return;
+    }
+
+    /* Walk the points, taking the biggest block that starts here each time */
+    for (first = from + 1; first < L->DataSize;)
+    {
+        for (level = FL_PLOTXY_PYRAMID_LEVELS - 1; level >= 0; level--)
+        {
+            shift = FL_PLOTXY_PYRAMID_SHIFT * (level + 1);
+            if ((first & ((1UL << shift) - 1)) != 0)
+                continue; /* Not on a block boundary */
+
+            b = first >> shift;
+            B = &P->Level[level][b];
+            last = (b + 1) << shift;
+            if (last > L->DataSize)
+                last = L->DataSize;
+
+            xx = PX + (int)((B->Xmin + L->X_Left) * L->X_Scale);
+            xe = PX + (int)((B->Xmax + L->X_Left) * L->X_Scale);
+
+            if (xe == xx || xe < PX || xx > PX + PW)
+                break; /* One column, or all off one side */
+        }
+
+        if (level < 0)
+        {
+            /* Nothing fits - take a single point */
+            line_pixels(L, first, first + 1, PX, PY + PH, xs, ys);
+            env_point(&E, xs[0], ys[0]);
+            first++;
+            continue;
+        }
+
+        /* Join on the first point of the block */
+        line_pixels(L, first, first + 1, PX, PY + PH, xs, ys);
+        env_point(&E, xs[0], ys[0]);
+
+        /* Then the block finishes on its last point */
+        line_pixels(L, last - 1, last, PX, PY + PH, xs, ys);
+        yy = ys[0];
+        if (xe == xx)
+        {
+            /* Whole block in this column */
+            if (PY + PH - (int)((B->Ymax + L->Y_Bottom) * L->Y_Scale) < E.cmin)
+                E.cmin = PY + PH - (int)((B->Ymax + L->Y_Bottom) * L->Y_Scale);
+            if (PY + PH - (int)((B->Ymin + L->Y_Bottom) * L->Y_Scale) > E.cmax)
+                E.cmax = PY + PH - (int)((B->Ymin + L->Y_Bottom) * L->Y_Scale);
+            E.clast = yy;
+        }
+        else
+        {
+            /* Off the plot - nothing inside it shows, the pen gets lifted */
+            E.col = xs[0];
+            E.cmin = E.cmax = E.clast = yy;
+        }
+        first = last;
+    }
+    env_flush(&E);
+    poly_end(&Poly);
+}
+
+/************************************************************************
+*                          draw_scales
+************************************************************************/
+void Fl_PlotXY::draw_scales(Fl_PlotXY_Line *L)
+{
+    double start, finish, step, tmp;
+
+    int xx, yy, tw, th, h, m, s, r, tt;
+    char str[20];
+
+    fl_font(AxisFontFace, AxisFontSize);
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::draw_scales(Fl_PlotXY_Line* L)\n");
+
+    /***** XAXIS ******/
+    if ((L->XMark & FL_PLOTXY_MARK_ON) && (L->XMarkSize != 0.0) && L->Displayed == 1)
+    {
+        /* Calculate the graduations using limits and scale etc */
+
+        step = L->XMarkSize;
+
+        start = (int)(L->Xmin / L->XMarkSize) * L->XMarkSize;
+
+        finish = L->Xmax;
+
+        if (P_DEBUG > 1)
+        {
+            printf(" Xmin=%lf, Xmax=%lf, XMarkSize=%lf, X_Scale=%lf\n", L->Xmin, L->Xmax, L->XMarkSize, L->X_Scale);
+            printf(" step=%lf, start=%lf, finish=%lf\n", step, start, finish);
+        }
+
+        /* Set Line Colour */
+        fl_color(L->C);
+
+        for (; start < finish; start += step)
+        {
+            xx = PX + (int)((start + L->X_Left) * L->X_Scale);
+            yy = PY + PH + 3;
+            fl_line(xx, yy, xx, yy + 5);
+
+            /* Print Value */
+            if ((L->XMark & FL_PLOTXY_MARK_VAL))
+            {
+
+                tt = (int)start;
+
+                r = (int)((start - (double)tt) * 100); /* hundReds */
+
+                h = tt / 3600; /* Hours */
+                tt = tt - (h * 3600);
+                m = tt / 60; /* Minutes */
+                tt = tt - (m * 60);
+                s = tt; /* Seconds */
+                tt -= s;
+
+                switch (L->XValType)
+                {
+                default:
+                case FL_PLOTXY_VAL_NUMBER:
+                    //sprintf(str,"%0.3f",start);
+                    sprintf(str, L->XValFormat, start);
+                    break;
+
+                case FL_PLOTXY_VAL_TIMEh:
+                    sprintf(str, "%02d", r);
+                    break;
+
+                case FL_PLOTXY_VAL_TIMESh:
+                    sprintf(str, "%02d.%02d", s, r);
+                    break;
+
+                case FL_PLOTXY_VAL_TIMEMSh:
+                    sprintf(str, "%02d:%02d.%02d", m, s, r);
+                    break;
+
+                case FL_PLOTXY_VAL_TIMEHMSh:
+                    sprintf(str, "%02d:%02d:%02d.%02d", h, m, s, r);
+                    break;
+
+                case FL_PLOTXY_VAL_TIMES:
+                    sprintf(str, "%02d", s);
+                    break;
+
+                case FL_PLOTXY_VAL_TIMEMS:
+                    sprintf(str, "%02d:%02d", m, s);
+                    break;
+
+                case FL_PLOTXY_VAL_TIMEHMS:
+                    sprintf(str, "%02d:%02d:%02d", h, m, s);
+                    break;
+
+                case FL_PLOTXY_VAL_TIMEHM:
+                    sprintf(str, "%02d:%02d", h, m);
+                    break;
+                }
+
+                tw = 0;
+                th = 0;
+                fl_measure(str, tw, th, 1);
+                xx = xx - (tw / 2);
+                yy = yy + th + 2;
+                fl_draw(str, xx, yy);
+            }
+        }
+    }
+
+    /***** Y AXIS ******/
+    if ((L->YMark & FL_PLOTXY_MARK_ON) && (L->YMarkSize != 0.0) && L->Displayed == 1)
+    {
+        /* Calculate the graduations using limits and scale etc */
+
+        step = L->YMarkSize;
+
+        start = (int)(L->Ymin / L->YMarkSize) * L->YMarkSize;
+
+        finish = L->Ymax;
+
+        if (P_DEBUG > 1)
+        {
+            printf(" Ymin=%lf, Ymax=%lf, YMarkSize=%lf, Y_Scale=%lf\n", L->Ymin, L->Ymax, L->YMarkSize, L->Y_Scale);
+            printf(" step=%lf, start=%lf, finish=%lf\n", step, start, finish);
+        }
+
+        /* Set Line Colour */
+        fl_color(L->C);
+
+        if (start > finish)
+        {
+            tmp = start;
+            start = finish;
+            finish = tmp;
+        }
+
+        for (; start < finish; start += step)
+        {
+            xx = PX - 8;
+            yy = PY + PH - (int)((start + L->Y_Bottom) * L->Y_Scale);
+            fl_line(xx, yy, xx + 5, yy);
+
+            /* Print Value */
+            if ((L->YMark & FL_PLOTXY_MARK_VAL))
+            {
+                switch (L->YValType)
+                {
+                default:
+                case FL_PLOTXY_VAL_NUMBER:
+                    //sprintf(str,"%0.3lf",start);
+                    sprintf(str, L->YValFormat, start);
+                    break;
+
+                case FL_PLOTXY_VAL_TIMEHM:
+                    tt = (int)start;
+                    h = tt / 3600;
+                    tt = tt - (h * 3600);
+                    m = tt / 60;
+                    sprintf(str, "%02d:%02d", h, m);
+                    break;
+
+                case FL_PLOTXY_VAL_TIMEHMS:
+                    tt = (int)start;
+                    h = tt / 3600;
+                    tt = tt - (h * 3600);
+                    m = tt / 60;
+                    tt = tt - (m * 60);
+                    s = tt;
+                    sprintf(str, "%02d:%02d:%02d", h, m, s);
+                    break;
+
+                case FL_PLOTXY_VAL_DATE:
+                    sprintf(str, "Date");
+                    break;
+                }
+
+                tw = 0;
+                th = 0;
+                fl_measure(str, tw, th, 1);
+                xx = xx - (tw)-2;
+                yy = yy + (th / 2);
+                fl_draw(str, xx, yy);
+            }
+        }
+    }
+}
+
+/************************************************************************
+*                          draw_axislabel
+************************************************************************/
+void Fl_PlotXY::draw_axislabel(Fl_PlotXY_Line *L)
+{
+    int xx, yy, tw, th;
+
+    if (P_DEBUG > 3)
+        printf("Fl_PlotXY::draw_axislabel()\n");
+
+    /* Set Line Colour */
+    fl_color(L->C);
+
+    fl_font(AxisFontFace, AxisFontSize);
+
+    if (L->Displayed == 0)
+        return;
+
+    fl_color(L->C);
+
+    /* X AXIS LABEL */
+    if ((L->XMark & FL_PLOTXY_MARK_ON) && (L->XMark & FL_PLOTXY_MARK_LABEL) && L->XLabel != NULL)
+    {
+        xx = PX + (PW / 2);
+        //yy=PY+PH+3;
+        yy = y() + h() - 5;
+
+        tw = 0;
+        th = 0;
+
+        fl_measure(L->XLabel, tw, th, 1);
+
+        xx = xx - (tw / 2);
+        //yy=yy+th+2;
+
+        // if(L->XMark & FL_PLOTXY_MARK_VAL) /* If values displayed as well - Add text height */
+        // {
+        //  yy+=th+2;
+        // }
+
+        fl_draw(L->XLabel, xx, yy);
+
+        //printf("X=%d, Y=%d, Label=\"%s\"\n",xx,yy,L->XLabel);
+    }
+
+    /* Y AXIS LABEL */
+    if ((L->YMark & FL_PLOTXY_MARK_ON) && (L->YMark & FL_PLOTXY_MARK_LABEL) && L->YLabel != NULL)
+    {
+        //xx=PX-AxisTextSpaceY-2;
+        xx = x() + 4;
+
+        yy = PY + (PH / 2);
+
+        tw = 0;
+        th = 0;
+        fl_measure(L->YLabel, tw, th, 1);
+
+        //xx=xx-th-2;
+        xx += th;
+        yy = yy + (tw / 2);
+
+/* Draw Y Label - Wrapped  THIS NEEDS WORK - Should be rotated 90 degrees!!*/
+#ifdef WIN32
+
+#else
+        draw_rotated(L->YLabel, xx, yy, 90);
+#endif
+    }
+}
+
+/************************************************************************
+*                          draw_linelabel
+************************************************************************/
+void Fl_PlotXY::draw_linelabel(Fl_PlotXY_Line *L)
+{
+    int xx, yy, tw = 0, th = 0;
+
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::draw_linelabel()\n");
+
+    if (P_DEBUG > 2)
+        printf(" Processing Line %d\n", L->LineNumber);
+
+    if (L->Displayed == 0)
+    {
+        if (P_DEBUG > 2)
+            printf(" Line %d Not displayed!\n", L->LineNumber);
+        return;
+    }
+
+    if (L->XMark & FL_PLOTXY_MARK_NAME != 0)
+    {
+        fl_font(AxisFontFace, AxisFontSize);
+
+        fl_color(L->C);
+
+        fl_measure(L->title, tw, th, 1);
+
+        xx = PX + PW - tw - 4;
+        yy = PY + 5 + ((L->LineNumber + 1) * (th + 2));
+
+        fl_draw(L->title, xx, yy);
+
+        if (P_DEBUG > 2)
+            printf(" X=%d, Y=%d, Title= %s\n", xx, yy, L->title);
+    }
+    else
+    {
+        if (P_DEBUG > 2)
+            printf(" Title Not enabled!");
+    }
+}
+
+/***********************************************************************
+*                         draw_vline
+***********************************************************************/
+void Fl_PlotXY::draw_vline(Fl_PlotXY_Line *L)
+{
+    char str[20];
+    int xx, yy, tw, th;
+    double X, Y;
+
+    if (P_DEBUG > 3)
+        printf("Fl_PlotXY::draw_vline(Fl_PlotXY_Line* L)\n");
+
+    /* Check for Data */
+    if (L->YCol.Data == NULL || L->DataSize == 0)
+        return;
+
+    if (VLinePos >= L->DataSize)
+        VLinePos = L->DataSize - 1;
+
+    /* Get Data*/
+    X = col_x(L, line_phys(L, VLinePos));
+    Y = col_y(L, line_phys(L, VLinePos));
+
+    xx = PX + (int)((X + L->X_Left) * L->X_Scale);
+    yy = PY + PH - (int)((Y + L->Y_Bottom) * L->Y_Scale);
+
+    /* Set Line Colour */
+    fl_color(fl_lighter(L->C));
+
+    /* Draw the vertical line */
+    fl_line(xx, PY, xx, PY + PH);
+
+    /* Draw the circle */
+    fl_circle(xx, yy, 5);
+
+    /* Draw the value amount */
+    sprintf(str, L->YValFormat, Y);
+
+    fl_font(AxisFontFace, AxisFontSize);
+    //fl_color(L->C);
+    //fl_measure(str,tw,th,1);
+
+    fl_draw(str, xx + 5, yy);
+}
+
+/************************************************************************
+*                            minmax
+* Min/Max calcute for auto scaling
+************************************************************************/
+void Fl_PlotXY::minmax(Fl_PlotXY_Line *L)
+{
+    unsigned long int first, n, p;
+
+    if (P_DEBUG > 3)
+        printf("Fl_PlotXY::minmax()\n");
+
+    if (L->YCol.Data == NULL || L->DataSize == 0)
+        return;
+
+    /* Only scan when add could not keep the range up to date */
+    if (!L->BoundsValid)
+    {
+        if (P_DEBUG > 3)
+            printf(" Scanning %ld points\n", L->DataSize);
+
+        /* Use First Values as Reference */
+        MinX = MaxX = col_x(L, line_phys(L, 0));
+        MinY = MaxY = col_y(L, line_phys(L, 0));
+
+        /* Scan Data for Min/Max X and then Min/Max Y values */
+        for (first = 0; first < L->DataSize; first += n)
+        {
+            n = line_run(L, first, L->DataSize, &p);
+            col_scan(&L->XCol, p, n, &MinX, &MaxX);
+            col_scan(&L->YCol, p, n, &MinY, &MaxY);
+        }
+
+        L->DataXmin = MinX;
+        L->DataXmax = MaxX;
+        L->DataYmin = MinY;
+        L->DataYmax = MaxY;
+        L->BoundsValid = 1;
+    }
+
+    MinX = L->Xmin = L->DataXmin;
+    MaxX = L->Xmax = L->DataXmax;
+    MinY = L->Ymin = L->DataYmin;
+    MaxY = L->Ymax = L->DataYmax;
+}
+
+/************************************************************************
+*                            setscale
+* Set up zoom scale etc
+************************************************************************/
+void Fl_PlotXY::setscale(Fl_PlotXY_Line *L)
+{
+    double mx, MX, my, MY;
+
+    if (P_DEBUG > 1)
+        printf("Fl_PlotXY::setscale(Fl_PlotXY_Line* L)\n");
+
+    /* Ensure Min and Max values are correct */
+
+    if (L->Xmax > L->Xmin)
+    {
+        mx = L->Xmin;
+        MX = L->Xmax;
+    }
+    else
+    {
+        mx = L->Xmax;
+        MX = L->Xmin;
+    }
+
+    if (L->Ymax > L->Ymin)
+    {
+        my = L->Ymin;
+        MY = L->Ymax;
+    }
+    else
+    {
+        my = L->Ymax;
+        MY = L->Ymin;
+    }
+
+    /* Calculate the Multiplyer for scaling */
+    if ((MX - mx) != 0)
+    {
+        L->X_Scale = (double)(PW) / (MX - mx);
+    }
+    else
+    {
+        /* If a divide by zero would occur - set scale to 1 */
+        L->X_Scale = 1;
+    }
+
+    if ((MY - my) != 0)
+    {
+        L->Y_Scale = (double)(PH) / (MY - my);
+    }
+    else
+    {
+        /* If a divide by zero would occur - set scale to 1 */
+        L->Y_Scale = 1;
+    }
+
+    /* Calculate the Shift for X and Y */
+    /* 0 minus lowest value give amout to Add to put at top/bottom */
+    L->X_Left = 0.0 - mx;
+    L->Y_Bottom = 0.0 - my;
+
+    if (P_DEBUG > 1)
+    {
+        printf(" X_Scale=%lf\n Y_Scale=%lf\n", L->X_Scale, L->Y_Scale);
+        printf(" X_Left=%lf\n Y_Bottom=%lf\n", L->X_Left, L->Y_Bottom);
+    }
+}
+
+/************************************************************************
+*                          Loading
+* A file is loaded from memory - mapped where it can be, read in whole
+* where not. Rows and fields are found with memchr, never past the end
+* of the file, and the rows are counted up front with text_count so
+* the lines have room for every point before the first is parsed.
+* Big files are split at new lines into parts parsed on threads of
+* their own, then added to the lines part by part, in order.
+************************************************************************/
+#define FL_PLOTXY_LOAD_POINTS 1024        /* Rows parsed before adding them in one go, without threads */
+#define FL_PLOTXY_LOAD_SPLIT (1UL << 20) /* Fewest bytes worth a thread of their own */
+
+/* A whole file in memory */
+typedef struct
+{
+    const char *Data;       /* First byte */
+    unsigned long int Size; /* Bytes */
+    int Mapped;             /* Data is a mapping rather than malloc'd */
+#ifdef WIN32
+    HANDLE File, Map;
+#endif
+} Fl_PlotXY_File;
+
+/* Read it in when it can not be mapped */
+static int file_read(Fl_PlotXY_File *F, const char *name)
+{
+    FILE *fptr;
+    char *d = NULL, *n;
+    unsigned long int size = 0, cap = 0;
+    size_t got;
+
+    if ((fptr = fopen(name, "rb")) == NULL)
+        return (0);
+
+    do
+    {
+        if (size == cap)
+        {
+            cap = cap ? cap * 2 : 65536;
+            if ((n = (char *)realloc(d, cap)) == NULL)
+            {
+                free(d);
+                fclose(fptr);
+                return (0);
+            }
+            d = n;
+        }
+        got = fread(d + size, 1, cap - size, fptr);
+        size += got;
+    } while (got != 0);
+
+    fclose(fptr);
+    F->Data = d;
+    F->Size = size;
+    F->Mapped = 0;
+    return (1);
+}
+
+/* Map a file, or read it in - sequential when it is read from start to end once */
+static int file_open(Fl_PlotXY_File *F, const char *name, int sequential)
+{
+#ifdef WIN32
+    LARGE_INTEGER size;
+
+    F->File = CreateFileA(name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                          sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL, NULL);
+    if (F->File != INVALID_HANDLE_VALUE)
+    {
+        if (GetFileSizeEx(F->File, &size) && size.QuadPart > 0 &&
+            (unsigned long long)size.QuadPart <= (unsigned long int)-1 &&
+            (F->Map = CreateFileMappingA(F->File, NULL, PAGE_READONLY, 0, 0, NULL)) != NULL)
+        {
+            if ((F->Data = (const char *)MapViewOfFile(F->Map, FILE_MAP_READ, 0, 0, 0)) != NULL)
+            {
+                F->Size = (unsigned long int)size.QuadPart;
+                F->Mapped = 1;
+                return (1);
+            }
+            CloseHandle(F->Map);
+        }
+        CloseHandle(F->File);
+    }
+#else
+    struct stat st;
+    void *m;
+    int fd;
+
+    if ((fd = open(name, O_RDONLY)) >= 0)
+    {
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 &&
+            (unsigned long long)st.st_size <= (unsigned long int)-1 &&
+            (m = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) != MAP_FAILED)
+        {
+#ifdef MADV_SEQUENTIAL
+            if (sequential)
+                madvise(m, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+            close(fd);
+            F->Data = (const char *)m;
+            F->Size = (unsigned long int)st.st_size;
+            F->Mapped = 1;
+            return (1);
+        }
+        close(fd);
+    }
+#endif
+
+    /* Empty, a pipe or no mapping - read it in */
+    return (file_read(F, name));
+}
+
+static void file_close(Fl_PlotXY_File *F)
+{
+    if (!F->Mapped)
+    {
+        free((void *)F->Data);
+        return;
+    }
+
+#ifdef WIN32
+    UnmapViewOfFile(F->Data);
+    CloseHandle(F->Map);
+    CloseHandle(F->File);
+#else
+    munmap((void *)F->Data, F->Size);
+#endif
+}
+
+/* End of the row starting at s - its new line, or the end of the file.
+ * *next is set to the start of the row after. */
+static const char *row_end(const char *s, const char *end, const char **next)
+{
+    const char *e;
+
+    if ((e = (const char *)memchr(s, '\n', end - s)) == NULL)
+    {
+        *next = end;
+        return (end);
+    }
+    *next = e + 1;
+    return (e);
+}
+
+/* A number strtod has to read - copied with '.' turned into point, the
+ * decimal point of the locale, so the file reads the same in any locale */
+static const char *num_slow(const char *q, const char *end, const char *s, char point, double *v)
+{
+    char buf[128], *b = buf, *t;
+    unsigned long int n;
+
+    /* Just the characters a number can have */
+    for (n = 0; q + n < end && ((q[n] >= '0' && q[n] <= '9') || ((q[n] | 0x20) >= 'a' && (q[n] | 0x20) <= 'z') ||
+                                q[n] == '.' || q[n] == '+' || q[n] == '-');
+         n++)
+        ;
+    if (n >= sizeof(buf) && (b = (char *)malloc(n + 1)) == NULL)
+    {
+        *v = 0.0;
+        return (s);
+    }
+    memcpy(b, q, n);
+    b[n] = 0;
+    if (point != '.' && (t = strchr(b, '.')) != NULL)
+        *t = point;
+
+    *v = strtod(b, &t);
+    n = t - b;
+    if (b != buf)
+        free(b);
+    return (n != 0 ? q + n : s);
+}
+
+/* Powers of ten a double holds exactly */
+static const double Pow10[23] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/************************************************************************
+*                          num_parse
+* Read a number from s, before end, to the same value atof gives but
+* whatever the locale. Up to 19 digits times 10^-22 to 10^22 are worked
+* out here: when the digits fit a double exactly the one multiply or
+* divide rounds correctly. Longer numbers, inf, nan and hex go to strtod,
+* point being the decimal point it expects.
+* Returns where the number ends - s, with *v = 0, if there is none.
+************************************************************************/
+static const char *num_parse(const char *s, const char *end, char point, double *v)
+{
+    const char *p = s, *q, *r;
+    unsigned long long m = 0;
+    long int e = 0, x;
+    int digits = 0, any = 0, neg = 0, eneg;
+
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n' || *p == '\v' || *p == '\f'))
+        p++;
+    q = p;
+    if (p < end && (*p == '+' || *p == '-'))
+        neg = *p++ == '-';
+
+    /* Digits, leading zeros do not count */
+    for (; p < end && *p >= '0' && *p <= '9'; p++, any = 1)
+    {
+        if (m == 0 && *p == '0')
+            continue;
+        if (++digits > 19)
+            return (num_slow(q, end, s, point, v));
+        m = m * 10 + (*p - '0');
+    }
+    if (p < end && *p == '.')
+    {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++, any = 1)
+        {
+            e--;
+            if (m == 0 && *p == '0')
+                continue;
+            if (++digits > 19)
+                return (num_slow(q, end, s, point, v));
+            m = m * 10 + (*p - '0');
+        }
+    }
+
+    if (!any)
+    {
+        /* inf or nan, or not a number */
+        if (p < end && ((*p | 0x20) == 'i' || (*p | 0x20) == 'n'))
+            return (num_slow(q, end, s, point, v));
+        *v = 0.0;
+        return (s);
+    }
+    if (p < end && (*p | 0x20) == 'x')
+        return (num_slow(q, end, s, point, v)); /* Hex */
+
+    /* Exponent, only if it has digits */
+    if (p < end && (*p | 0x20) == 'e')
+    {
+        r = p + 1;
+        eneg = 0;
+        if (r < end && (*r == '+' || *r == '-'))
+            eneg = *r++ == '-';
+        if (r < end && *r >= '0' && *r <= '9')
+        {
+            for (x = 0; r < end && *r >= '0' && *r <= '9'; r++)
+                if (x < 100000)
+                    x = x * 10 + (*r - '0');
+            e += eneg ? -x : x;
+            p = r;
+        }
+    }
+
+    if (m == 0)
+        *v = 0.0;
+    else if (m <= (1ULL << 53) && e >= -22 && e <= 22)
+        *v = e < 0 ? (double)m / Pow10[-e] : (double)m * Pow10[e];
+    else
+        return (num_slow(q, end, s, point, v));
+
+    if (neg)
+        *v = -*v;
+    return (p);
+}
+
+/* Whole number from s, before end, the same as atoi */
+static long int int_parse(const char *s, const char *end)
+{
+    long int n = 0;
+    int neg = 0;
+
+    while (s < end && (*s == ' ' || *s == '\t'))
+        s++;
+    if (s < end && (*s == '+' || *s == '-'))
+        neg = *s++ == '-';
+    for (; s < end && *s >= '0' && *s <= '9'; s++)
+        if (n < 100000000L)
+            n = n * 10 + (*s - '0');
+    return (neg ? -n : n);
+}
+
+/* HH:MM:SS from s, before end, in seconds */
+static double time_parse(const char *s, const char *end)
+{
+    long int t[3] = {0, 0, 0};
+    int count;
+
+    for (count = 0; count < 3 && s != NULL; count++)
+    {
+        t[count] = int_parse(s, end);
+        if ((s = (const char *)memchr(s, ':', end - s)) != NULL)
+            s++;
+    }
+    return ((double)t[0] * 3600.0 + (double)t[1] * 60.0 + (double)t[2]);
+}
+
+/* A label of up to 40 characters from s, ended by end or any of the
+ * characters in stop. It is kept in the pool until the next load. */
+static const char *load_label(Fl_PlotXY_Pool *P, const char *s, const char *end, const char *stop)
+{
+    unsigned long int n;
+    const char *t;
+
+    for (n = 0; n < 40 && s + n < end && strchr(stop, s[n]) == NULL; n++)
+        ; /* Limit Label size to 40 Characters */
+
+    return ((t = pool_string(P, s, n)) != NULL ? t : "");
+}
+
+/* Rows of a file parsed by one thread */
+typedef struct
+{
+    const char *Start, *End; /* Rows still to parse, whole rows */
+    int XY;                  /* Rows for load - X,Y, numbers only */
+    int Columns;             /* Y values a row */
+    char Point;              /* Decimal point of the locale */
+    int Time;                /* Some X were HH:MM:SS */
+    unsigned long int Rows;  /* Rows parsed into X and Y */
+    unsigned long int Room;  /* Most rows X and Y hold */
+    double *X;               /* X of each row */
+    double *Y;               /* Y values of each column, Room apart */
+} Fl_PlotXY_Rows;
+
+/************************************************************************
+*                          rows_parse
+* Parse rows until the end of the part or R->Room rows.
+* R->Start moves on to the first row not parsed.
+************************************************************************/
+static void rows_parse(Fl_PlotXY_Rows *R)
+{
+    const char *p = R->Start, *row, *rend, *sptr, *xend;
+    double *ys;
+    int count;
+
+    while (p < R->End && R->Rows < R->Room)
+    {
+        row = p;
+        rend = row_end(row, R->End, &p);
+        xend = (const char *)memchr(row, ',', rend - row);
+        ys = R->Y + R->Rows;
+
+        if (R->XY)
+        {
+            /* Check if it is numbers or characters, X then the Y after the first comma */
+            if (row == rend || !((row[0] >= '0' && row[0] <= '9') || row[0] == '-') || xend == NULL)
+                continue;
+            num_parse(row, rend, R->Point, &R->X[R->Rows]);
+            num_parse(xend + 1, rend, R->Point, ys);
+            R->Rows++;
+            continue;
+        }
+
+        if (memchr(row, ':', (xend != NULL ? xend : rend) - row) != NULL)
+        {
+            /* Looks like the first column is time..... */
+            R->X[R->Rows] = time_parse(row, xend != NULL ? xend : rend);
+            R->Time = 1;
+        }
+        else
+        {
+            /* Get X Value  */
+            num_parse(row, rend, R->Point, &R->X[R->Rows]);
+        }
+
+        /* Go to first comma */
+        if ((sptr = xend) == NULL)
+            continue;
+
+        /* Decode data to get Y values, 0 past the end of the line */
+        for (count = 0; count < R->Columns; count++)
+        {
+            /* Moving the numerical value on Line */
+            while (sptr != NULL && sptr < rend && strchr("0123456789+-.", *sptr) == NULL)
+                sptr++;
+            if (sptr == rend)
+                sptr = NULL;
+            ys[count * R->Room] = 0.0;
+            if (sptr != NULL)
+            {
+                sptr = num_parse(sptr, rend, R->Point, &ys[count * R->Room]);
+                sptr = (const char *)memchr(sptr, ',', rend - sptr);
+            }
+        }
+        R->Rows++;
+    }
+
+    R->Start = p;
+}
+
+static void rows_drop(Fl_PlotXY_Rows *R)
+{
+    free(R->X);
+    free(R->Y);
+    R->X = R->Y = NULL;
+    R->Room = 0;
+}
+
+/* Room for room rows in place of what there was - 0 when out of memory */
+static int rows_room(Fl_PlotXY_Rows *R, unsigned long int room)
+{
+    unsigned long int width = R->Columns > 0 ? R->Columns : 1;
+
+    rows_drop(R);
+    if (room > (unsigned long int)-1 / sizeof(double) / width ||
+        (R->X = (double *)malloc(room * sizeof(double))) == NULL ||
+        (R->Y = (double *)malloc(room * width * sizeof(double))) == NULL)
+    {
+        rows_drop(R);
+        return (0);
+    }
+    R->Room = room;
+    return (1);
+}
+
+/* A whole part in one go - with no memory for it the part is left to rows_next */
+static void rows_part(Fl_PlotXY_Rows *R)
+{
+    if (rows_room(R, text_count(R->Start, R->End - R->Start, '\n') + 1))
+        rows_parse(R);
+}
+
+/* The next rows of a part not parsed in one go, FL_PLOTXY_LOAD_POINTS
+ * at a time. Returns 0 at the end of the part or when out of memory. */
+static int rows_next(Fl_PlotXY_Rows *R)
+{
+    if (R->Start == R->End || (R->Room == 0 && !rows_room(R, FL_PLOTXY_LOAD_POINTS)))
+        return (0);
+
+    R->Rows = 0;
+    rows_parse(R);
+    return (1);
+}
+
+/* Rows the parts will add up to, those still to parse counted */
+static unsigned long int rows_size(const Fl_PlotXY_Rows *R, int n)
+{
+    unsigned long int size = 0;
+    int count;
+
+    for (count = 0; count < n; count++)
+    {
+        size += R[count].Rows;
+        if (R[count].Start != R[count].End)
+            size += text_count(R[count].Start, R[count].End - R[count].Start, '\n') + 1;
+    }
+    return (size);
+}
+
+#ifdef WIN32
+static DWORD WINAPI rows_thread(LPVOID R)
+{
+    rows_part((Fl_PlotXY_Rows *)R);
+    return (0);
+}
+#else
+static void *rows_thread(void *R)
+{
+    rows_part((Fl_PlotXY_Rows *)R);
+    return (NULL);
+}
+#endif
+
+/* Processors to parse on */
+static int load_cpus(void)
+{
+#ifdef WIN32
+    SYSTEM_INFO si;
+
+    GetSystemInfo(&si);
+    return ((int)si.dwNumberOfProcessors);
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long int n = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return (n > 0 ? (int)n : 1);
+#else
+    return (1);
+#endif
+}
+
+static void rows_free(Fl_PlotXY_Rows *R, int n)
+{
+    int count;
+
+    for (count = 0; count < n; count++)
+        rows_drop(&R[count]);
+    free(R);
+}
+
+/************************************************************************
+*                          rows_split
+* Share the rows from start to end between up to threads parts, each
+* ending at a new line and at least FL_PLOTXY_LOAD_SPLIT bytes.
+* Returns the parts, *n of them, or NULL when out of memory.
+************************************************************************/
+static Fl_PlotXY_Rows *rows_split(const char *start, const char *end, int xy, int columns, int threads, int *n)
+{
+    Fl_PlotXY_Rows *R;
+    const char *p = start, *q;
+    const char *dp = localeconv()->decimal_point;
+    unsigned long int size = end - start;
+    int count, parts;
+
+    parts = (int)(size / FL_PLOTXY_LOAD_SPLIT) + 1;
+    if (threads > FL_PLOTXY_LOAD_THREADS)
+        threads = FL_PLOTXY_LOAD_THREADS;
+    if (parts > threads)
+        parts = threads;
+    if (parts < 1)
+        parts = 1;
+
+    if ((R = (Fl_PlotXY_Rows *)calloc(parts, sizeof(Fl_PlotXY_Rows))) == NULL)
+        return (NULL);
+
+    for (count = 0; count < parts; count++, p = q)
+    {
+        /* An even share, on to the end of its last row */
+        q = start + size / parts * (count + 1);
+        if (count == parts - 1)
+            q = end;
+        else if (q < p)
+            q = p;
+        else if ((q = (const char *)memchr(q, '\n', end - q)) == NULL)
+            q = end;
+        else
+            q++;
+
+        R[count].Start = p;
+        R[count].End = q;
+        R[count].XY = xy;
+        R[count].Columns = columns;
+        R[count].Point = (dp[0] != 0 && dp[1] == 0) ? dp[0] : '.';
+    }
+
+    *n = parts;
+    return (R);
+}
+
+/************************************************************************
+*                          rows_run
+* Parse the parts, each on a thread of its own but the first, which
+* this thread does. A part whose thread did not start is parsed here
+* too. One part is left to rows_next, a block at a time.
+************************************************************************/
+static void rows_run(Fl_PlotXY_Rows *R, int n)
+{
+#ifdef WIN32
+    HANDLE T[FL_PLOTXY_LOAD_THREADS];
+#else
+    pthread_t T[FL_PLOTXY_LOAD_THREADS];
+#endif
+    int started[FL_PLOTXY_LOAD_THREADS];
+    int count;
+
+    if (n < 2)
+        return;
+
+    for (count = 1; count < n; count++)
+    {
+#ifdef WIN32
+        started[count] = (T[count] = CreateThread(NULL, 0, rows_thread, &R[count], 0, NULL)) != NULL;
+#else
+        started[count] = pthread_create(&T[count], NULL, rows_thread, &R[count]) == 0;
+#endif
+    }
+
+    rows_part(&R[0]);
+
+    for (count = 1; count < n; count++)
+    {
+        if (!started[count])
+        {
+            rows_part(&R[count]);
+            continue;
+        }
+#ifdef WIN32
+        WaitForSingleObject(T[count], INFINITE);
+        CloseHandle(T[count]);
+#else
+        pthread_join(T[count], NULL);
+#endif
+    }
+}
+
+/************************************************************************
+*                          rows_add
+* Add the rows of the n parts in order - X,Y to line target for load,
+* a row to the lines of group target for loadxyyy, ys room for a Y
+* pointer a line. A part not parsed in one go is parsed here a block at
+* a time. The parts are freed. Returns 1 if some X were HH:MM:SS.
+************************************************************************/
+static int rows_add(Fl_PlotXY *W, int target, Fl_PlotXY_Rows *R, int n, const double **ys)
+{
+    int count, col, time = 0;
+
+    for (count = 0; count < n; count++)
+    {
+        do
+        {
+            if (R[count].XY)
+                W->add(target, R[count].X, R[count].Y, R[count].Rows);
+            else
+            {
+                for (col = 0; col < R[count].Columns; col++)
+                    ys[col] = R[count].Y + col * R[count].Room;
+                W->add_rows(target, R[count].X, ys, R[count].Rows); /* Add Data to graph */
+            }
+        } while (rows_next(&R[count]));
+        rows_drop(&R[count]);
+
+        if (R[count].Time)
+            time = 1;
+    }
+    if (R != NULL)
+        rows_free(R, n);
+    return (time);
+}
+
+/* Lines of a loadxyyy file - a comma in its first row for each - and
+ * where its values start, after the two title rows */
+static int xyyy_columns(const char *start, const char *end, const char **rows)
+{
+    const char *rend, *p;
+    int columns;
+
+    rend = row_end(start, end, &p);
+    columns = (int)text_count(start, rend - start, ',');
+    row_end(p, end, rows);
+    return (columns);
+}
+
+/* Axis modes of loaded loadxyyy lines, time if some X were HH:MM:SS */
+static void xyyy_marks(Fl_PlotXY *W, const int *lines, int columns, int time)
+{
+    int count;
+
+    for (count = 0; count < columns; count++)
+    {
+        W->xvaltype(lines[count], time ? FL_PLOTXY_VAL_TIMEHMS : FL_PLOTXY_VAL_NUMBER);
+        W->xmarkon(lines[count], FL_PLOTXY_MARK_ON | FL_PLOTXY_MARK_LABEL | FL_PLOTXY_MARK_NAME);
+        W->ymarkon(lines[count], FL_PLOTXY_MARK_ON | FL_PLOTXY_MARK_LABEL);
+    }
+}
+
+/************************************************************************
+*                          load
+*
+* Loads Comma Separated Value (CSV) File from Disk
+* Data MUST be arranged as X,Y
+* Any NON Numerical data is Not added to the graph.
+* Returns 1 on sucess 0 on failure
+************************************************************************/
+int Fl_PlotXY::load(const char *FileName)
+{
+    Fl_PlotXY_Line *L;
+    Fl_PlotXY_File F;
+    Fl_PlotXY_Rows *R;
+    int line, parts;
+
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::load(int,char*)\n");
+
+    if (!file_open(&F, FileName, 1))
+        return (-1);
+
+    /* Create New line */
+    if ((line = newline()) == -1)
+    {
+        file_close(&F);
+        return (-1);
+    }
+
+    /* Parse the parts of the file, then add their points in order */
+    if ((R = rows_split(F.Data, F.Data + F.Size, 1, 1, LoadThreads ? LoadThreads : load_cpus(), &parts)) == NULL)
+    {
+        file_close(&F);
+        remove(line);
+        return (-1);
+    }
+    rows_run(R, parts);
+
+    /* Room for a point a row */
+    reserve(line, rows_size(R, parts));
+
+    rows_add(this, line, R, parts, NULL);
+    file_close(&F);
+
+    if ((L = getselected(line)) == NULL)
+        return (-1);
+    minmax(L);
+
+    redraw();
+    return (line);
+}
+
+/************************************************************************
+*                          Saving
+* Rows are written out a block at a time, each block into a buffer of
+* about FL_PLOTXY_SAVE_BUFFER bytes, and the buffers go to the file
+* whole. Numbers are written with the fewest digits that read back to
+* the same double, '.' as the decimal point.
+************************************************************************/
+#define FL_PLOTXY_SAVE_BUFFER (1UL << 20) /* Bytes of rows written out in one go */
+#define FL_PLOTXY_NUM_CHARS 32            /* Most characters num_write writes */
+
+typedef struct
+{
+    FILE *F;
+    unsigned long int Used; /* Bytes in Buf not yet written */
+    int Error;
+    char Buf[4096]; /* Titles and labels, rows go straight to F */
+} Fl_PlotXY_Out;
+
+/* Open name to write through O */
+static int out_open(Fl_PlotXY_Out *O, const char *name)
+{
+    if ((O->F = fopen(name, "w")) == NULL)
+        return (0);
+    setvbuf(O->F, NULL, _IONBF, 0); /* Everything comes a buffer at a time */
+    O->Used = 0;
+    O->Error = 0;
+    return (1);
+}
+
+/* Write out the buffer */
+static void out_flush(Fl_PlotXY_Out *O)
+{
+    if (O->Used != 0 && fwrite(O->Buf, 1, O->Used, O->F) != O->Used)
+        O->Error = 1;
+    O->Used = 0;
+}
+
+/* Write a string of any length, NULL as nothing */
+static void out_text(Fl_PlotXY_Out *O, const char *s)
+{
+    unsigned long int n, len;
+
+    for (len = s != NULL ? strlen(s) : 0; len > 0; s += n, len -= n)
+    {
+        if (O->Used == sizeof(O->Buf))
+            out_flush(O);
+        n = sizeof(O->Buf) - O->Used < len ? sizeof(O->Buf) - O->Used : len;
+        memcpy(O->Buf + O->Used, s, n);
+        O->Used += n;
+    }
+}
+
+/* Write the rest and close - 0 if any of it could not be written */
+static int out_close(Fl_PlotXY_Out *O)
+{
+    out_flush(O);
+    if (fclose(O->F) != 0)
+        O->Error = 1;
+    return (!O->Error);
+}
+
+/* A double as F * 2^E */
+typedef struct
+{
+    unsigned long long F;
+    int E;
+} Fl_PlotXY_Fp;
+
+/* 10^-348, 10^-340 ... 10^340 as 64 bit F, the top bit set */
+static const Fl_PlotXY_Fp NumPow[87] = {
+    {0xfa8fd5a0081c0288ULL, -1220}, {0xbaaee17fa23ebf76ULL, -1193}, {0x8b16fb203055ac76ULL, -1166},
+    {0xcf42894a5dce35eaULL, -1140}, {0x9a6bb0aa55653b2dULL, -1113}, {0xe61acf033d1a45dfULL, -1087},
+    {0xab70fe17c79ac6caULL, -1060}, {0xff77b1fcbebcdc4fULL, -1034}, {0xbe5691ef416bd60cULL, -1007},
+    {0x8dd01fad907ffc3cULL, -980}, {0xd3515c2831559a83ULL, -954}, {0x9d71ac8fada6c9b5ULL, -927},
+    {0xea9c227723ee8bcbULL, -901}, {0xaecc49914078536dULL, -874}, {0x823c12795db6ce57ULL, -847},
+    {0xc21094364dfb5637ULL, -821}, {0x9096ea6f3848984fULL, -794}, {0xd77485cb25823ac7ULL, -768},
+    {0xa086cfcd97bf97f4ULL, -741}, {0xef340a98172aace5ULL, -715}, {0xb23867fb2a35b28eULL, -688},
+    {0x84c8d4dfd2c63f3bULL, -661}, {0xc5dd44271ad3cdbaULL, -635}, {0x936b9fcebb25c996ULL, -608},
+    {0xdbac6c247d62a584ULL, -582}, {0xa3ab66580d5fdaf6ULL, -555}, {0xf3e2f893dec3f126ULL, -529},
+    {0xb5b5ada8aaff80b8ULL, -502}, {0x87625f056c7c4a8bULL, -475}, {0xc9bcff6034c13053ULL, -449},
+    {0x964e858c91ba2655ULL, -422}, {0xdff9772470297ebdULL, -396}, {0xa6dfbd9fb8e5b88fULL, -369},
+    {0xf8a95fcf88747d94ULL, -343}, {0xb94470938fa89bcfULL, -316}, {0x8a08f0f8bf0f156bULL, -289},
+    {0xcdb02555653131b6ULL, -263}, {0x993fe2c6d07b7facULL, -236}, {0xe45c10c42a2b3b06ULL, -210},
+    {0xaa242499697392d3ULL, -183}, {0xfd87b5f28300ca0eULL, -157}, {0xbce5086492111aebULL, -130},
+    {0x8cbccc096f5088ccULL, -103}, {0xd1b71758e219652cULL, -77}, {0x9c40000000000000ULL, -50},
+    {0xe8d4a51000000000ULL, -24}, {0xad78ebc5ac620000ULL, 3}, {0x813f3978f8940984ULL, 30},
+    {0xc097ce7bc90715b3ULL, 56}, {0x8f7e32ce7bea5c70ULL, 83}, {0xd5d238a4abe98068ULL, 109},
+    {0x9f4f2726179a2245ULL, 136}, {0xed63a231d4c4fb27ULL, 162}, {0xb0de65388cc8ada8ULL, 189},
+    {0x83c7088e1aab65dbULL, 216}, {0xc45d1df942711d9aULL, 242}, {0x924d692ca61be758ULL, 269},
+    {0xda01ee641a708deaULL, 295}, {0xa26da3999aef774aULL, 322}, {0xf209787bb47d6b85ULL, 348},
+    {0xb454e4a179dd1877ULL, 375}, {0x865b86925b9bc5c2ULL, 402}, {0xc83553c5c8965d3dULL, 428},
+    {0x952ab45cfa97a0b3ULL, 455}, {0xde469fbd99a05fe3ULL, 481}, {0xa59bc234db398c25ULL, 508},
+    {0xf6c69a72a3989f5cULL, 534}, {0xb7dcbf5354e9beceULL, 561}, {0x88fcf317f22241e2ULL, 588},
+    {0xcc20ce9bd35c78a5ULL, 614}, {0x98165af37b2153dfULL, 641}, {0xe2a0b5dc971f303aULL, 667},
+    {0xa8d9d1535ce3b396ULL, 694}, {0xfb9b7cd9a4a7443cULL, 720}, {0xbb764c4ca7a44410ULL, 747},
+    {0x8bab8eefb6409c1aULL, 774}, {0xd01fef10a657842cULL, 800}, {0x9b10a4e5e9913129ULL, 827},
+    {0xe7109bfba19c0c9dULL, 853}, {0xac2820d9623bf429ULL, 880}, {0x80444b5e7aa7cf85ULL, 907},
+    {0xbf21e44003acdd2dULL, 933}, {0x8e679c2f5e44ff8fULL, 960}, {0xd433179d9c8cb841ULL, 986},
+    {0x9e19db92b4e31ba9ULL, 1013}, {0xeb96bf6ebadf77d9ULL, 1039}, {0xaf87023b9bf0ee6bULL, 1066}};
+
+/* Powers of ten as whole numbers */
+static const unsigned long long NumTen[20] = {1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+                                              10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+                                              100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+                                              100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+                                              100000000000000000ULL, 1000000000000000000ULL,
+                                              10000000000000000000ULL};
+
+/* a * b, the top 64 bits rounded */
+static Fl_PlotXY_Fp fp_mul(Fl_PlotXY_Fp a, Fl_PlotXY_Fp b)
+{
+    const unsigned long long M32 = 0xFFFFFFFFULL;
+    unsigned long long ah = a.F >> 32, al = a.F & M32, bh = b.F >> 32, bl = b.F & M32;
+    unsigned long long hl = ah * bl, lh = al * bh, mid;
+    Fl_PlotXY_Fp r;
+
+    mid = ((al * bl) >> 32) + (hl & M32) + (lh & M32) + (1ULL << 31);
+    r.F = ah * bh + (hl >> 32) + (lh >> 32) + (mid >> 32);
+    r.E = a.E + b.E + 64;
+    return (r);
+}
+
+/* Shift F up until its top bit is set */
+static Fl_PlotXY_Fp fp_norm(Fl_PlotXY_Fp a)
+{
+    while (!(a.F & (1ULL << 63)))
+    {
+        a.F <<= 1;
+        a.E--;
+    }
+    return (a);
+}
+
+/* Take the last digit down while that keeps it nearer the value and
+ * inside the range it has to be in */
+static void num_round(char *digits, int n, unsigned long long delta, unsigned long long rest, unsigned long long ten,
+                      unsigned long long wp_w)
+{
+    while (rest < wp_w && delta - rest >= ten && (rest + ten < wp_w || wp_w - rest > rest + ten - wp_w))
+    {
+        digits[n - 1]--;
+        rest += ten;
+    }
+}
+
+/************************************************************************
+*                          num_digits
+* The digits of v > 0, the fewest that are nearer v than any other
+* double - Loitsch's Grisu2. The scaled bounds are a little inside the
+* true ones so the digits always read back to v, a few one longer than
+* they need be.
+* Returns how many digits and sets K - v is the digits * 10^K.
+************************************************************************/
+static int num_digits(double v, char *digits, int *K)
+{
+    union
+    {
+        double d;
+        unsigned long long u;
+    } bits;
+    Fl_PlotXY_Fp w, mp, mm, c, one;
+    unsigned long long delta, p2, wp_w, rest;
+    unsigned int p1;
+    int kappa, n = 0, k, index, e;
+    double dk;
+
+    /* v as F * 2^E, and the bounds of the doubles either side */
+    bits.d = v;
+    e = (int)((bits.u >> 52) & 0x7FF);
+    w.F = bits.u & ((1ULL << 52) - 1);
+    if (e != 0)
+    {
+        w.F += 1ULL << 52;
+        w.E = e - 1075;
+    }
+    else
+        w.E = -1074;
+    mp.F = (w.F << 1) + 1;
+    mp.E = w.E - 1;
+    mp = fp_norm(mp);
+    if (w.F == (1ULL << 52))
+    {
+        mm.F = (w.F << 2) - 1;
+        mm.E = w.E - 2;
+    }
+    else
+    {
+        mm.F = (w.F << 1) - 1;
+        mm.E = w.E - 1;
+    }
+    mm.F <<= mm.E - mp.E;
+    mm.E = mp.E;
+    w = fp_norm(w);
+
+    /* Scale by the cached power that brings the upper bound to 2^-60 .. 2^-32 */
+    dk = (-61 - mp.E) * 0.30102999566398114 + 347;
+    k = (int)dk;
+    if (dk - k > 0.0)
+        k++;
+    index = (k >> 3) + 1;
+    *K = -(-348 + index * 8);
+    c = NumPow[index];
+    w = fp_mul(w, c);
+    mp = fp_mul(mp, c);
+    mm = fp_mul(mm, c);
+    mm.F++;
+    mp.F--;
+
+    /* Digits of the whole part, then of the fraction, until in range */
+    delta = mp.F - mm.F;
+    wp_w = mp.F - w.F;
+    one.E = mp.E;
+    one.F = 1ULL << -one.E;
+    p1 = (unsigned int)(mp.F >> -one.E);
+    p2 = mp.F & (one.F - 1);
+    for (kappa = 1; kappa < 10 && p1 >= NumTen[kappa]; kappa++)
+        ;
+
+    while (kappa > 0)
+    {
+        kappa--;
+        index = (int)(p1 / NumTen[kappa]);
+        p1 = (unsigned int)(p1 % NumTen[kappa]);
+        if (index != 0 || n != 0)
+            digits[n++] = (char)('0' + index);
+        rest = ((unsigned long long)p1 << -one.E) + p2;
+        if (rest <= delta)
+        {
+            *K += kappa;
+            num_round(digits, n, delta, rest, NumTen[kappa] << -one.E, wp_w);
+            return (n);
+        }
+    }
+
+    for (;;)
+    {
+        p2 *= 10;
+        delta *= 10;
+        index = (int)(p2 >> -one.E);
+        if (index != 0 || n != 0)
+            digits[n++] = (char)('0' + index);
+        p2 &= one.F - 1;
+        kappa--;
+        if (p2 < delta)
+        {
+            *K += kappa;
+            num_round(digits, n, delta, p2, one.F, -kappa < 20 ? wp_w * NumTen[-kappa] : 0);
+            return (n);
+        }
+    }
+}
+
+/************************************************************************
+*                          num_write
+* Write v to s with the fewest digits that read back to the same double,
+* '.' as the decimal point whatever the locale, and return how many
+* characters there are - no more than FL_PLOTXY_NUM_CHARS.
+* Like %g: plain below 10^17 and from 0.0001, else d.ddde+XX.
+************************************************************************/
+static int num_write(char *s, double v)
+{
+    char digits[24], *t = s;
+    int n, K, point, count, e;
+
+    if (v != v)
+    {
+        memcpy(s, "nan", 3);
+        return (3);
+    }
+    if (v < 0.0 || (v == 0.0 && 1.0 / v < 0.0))
+    {
+        *t++ = '-';
+        v = -v;
+    }
+    if (v == 0.0)
+    {
+        *t++ = '0';
+        return (t - s);
+    }
+    if (v > 1.7976931348623157e308)
+    {
+        memcpy(t, "inf", 3);
+        return (t + 3 - s);
+    }
+
+    n = num_digits(v, digits, &K);
+    point = n + K; /* Digits before the decimal point */
+
+    if (K >= 0 && point <= 17)
+    {
+        /* Whole number */
+        memcpy(t, digits, n);
+        t += n;
+        for (count = 0; count < K; count++)
+            *t++ = '0';
+    }
+    else if (point > 0 && point <= 17)
+    {
+        memcpy(t, digits, point);
+        t += point;
+        *t++ = '.';
+        memcpy(t, digits + point, n - point);
+        t += n - point;
+    }
+    else if (point > -4 && point <= 0)
+    {
+        /* 0.000ddd */
+        *t++ = '0';
+        *t++ = '.';
+        for (count = point; count < 0; count++)
+            *t++ = '0';
+        memcpy(t, digits, n);
+        t += n;
+    }
+    else
+    {
+        *t++ = digits[0];
+        if (n > 1)
+        {
+            *t++ = '.';
+            memcpy(t, digits + 1, n - 1);
+            t += n - 1;
+        }
+        e = point - 1;
+        *t++ = 'e';
+        *t++ = e < 0 ? '-' : '+';
+        if (e < 0)
+            e = -e;
+        if (e >= 100)
+            *t++ = (char)('0' + e / 100);
+        *t++ = (char)('0' + e / 10 % 10);
+        *t++ = (char)('0' + e % 10);
+    }
+    return (t - s);
+}
+
+/* Rows of a save, written out by one thread */
+typedef struct
+{
+    Fl_PlotXY_Line *XL;            /* X values come from this line */
+    Fl_PlotXY_Line **Lines;        /* Y values from each of these, 0 past their end */
+    int Count;                     /* Lines */
+    int Time;                      /* X as HH:MM:SS.hh */
+    unsigned long int First, Last; /* Rows [First,Last) */
+    char *Buf;
+    unsigned long int Used;
+} Fl_PlotXY_Csv;
+
+#define FL_PLOTXY_TIME_CHARS 48 /* Most characters of an HH:MM:SS.hh */
+
+/* Write the rows of T into its buffer */
+static void csv_part(Fl_PlotXY_Csv *T)
+{
+    unsigned long int row;
+    int count, H, M, S, h;
+    double X;
+    char *b = T->Buf;
+
+    for (row = T->First; row < T->Last; row++)
+    {
+        X = col_x(T->XL, line_phys(T->XL, row));
+        if (!T->Time)
+            b += num_write(b, X);
+        else
+        {
+            H = (int)(X / 3600); /* Calc Hours */
+            X -= (double)(H * 3600);
+            M = (int)(X / 60); /* Calc Minutes */
+            X -= (double)(M * 60);
+            S = (int)X; /* Calc Seconds */
+            X -= (double)S;
+            h = (int)(X * 100); /* Calc hundreths */
 
-                case FL_PLOTXY_VAL_TIMEHM:
-                    sprintf(str, "%02d:%02d", h, m);
-                    break;
-                }
+            b += sprintf(b, "%02d:%02d:%02d.%02d", H, M, S, h);
+        }
 
-                tw = 0;
-                th = 0;
-                fl_measure(str, tw, th, 1);
-                xx = xx - (tw / 2);
-                yy = yy + th + 2;
-                fl_draw(str, xx, yy);
-            }
+        for (count = 0; count < T->Count; count++)
+        {
+            *b++ = ',';
+            b += num_write(b, row < T->Lines[count]->DataSize
+                                  ? col_y(T->Lines[count], line_phys(T->Lines[count], row))
+                                  : 0.0);
         }
+        *b++ = '\n';
     }
+    T->Used = b - T->Buf;
+}
 
-    /***** Y AXIS ******/
-    if ((L->YMark & FL_PLOTXY_MARK_ON) && (L->YMarkSize != 0.0) && L->Displayed == 1)
-    {
-        /* Calculate the graduations using limits and scale etc */
-
-        step = L->YMarkSize;
+#ifdef WIN32
+static DWORD WINAPI csv_thread(LPVOID T)
+{
+    csv_part((Fl_PlotXY_Csv *)T);
+    return (0);
+}
+#else
+static void *csv_thread(void *T)
+{
+    csv_part((Fl_PlotXY_Csv *)T);
+    return (NULL);
+}
+#endif
 
-        start = (int)(L->Ymin / L->YMarkSize) * L->YMarkSize;
+/************************************************************************
+*                          csv_rows
+* Write rows of X then the Y of each line - the rows of XL.
+* Up to threads blocks of rows are written out at once, each into a
+* buffer of about FL_PLOTXY_SAVE_BUFFER bytes on a thread of its own but
+* the first, then go to the file in order.
+* After each go more, if not NULL, is given the rows written - it
+* returns 0 to stop there.
+* Returns 0 when out of memory.
+************************************************************************/
+static int csv_rows(Fl_PlotXY_Out *O, Fl_PlotXY_Line *XL, Fl_PlotXY_Line **lines, int count, int time, int threads,
+                    int (*more)(void *, unsigned long int), void *arg)
+{
+    Fl_PlotXY_Csv T[FL_PLOTXY_LOAD_THREADS];
+#ifdef WIN32
+    HANDLE H[FL_PLOTXY_LOAD_THREADS];
+#else
+    pthread_t H[FL_PLOTXY_LOAD_THREADS];
+#endif
+    int started[FL_PLOTXY_LOAD_THREADS];
+    unsigned long int rows, row, block, room;
+    int parts, part, n;
+
+    rows = XL != NULL ? XL->DataSize : 0;
+    room = FL_PLOTXY_TIME_CHARS + count * (FL_PLOTXY_NUM_CHARS + 1) + 1; /* Most a row can take */
+    if ((block = FL_PLOTXY_SAVE_BUFFER / room) == 0)
+        block = 1;
+
+    if (threads > FL_PLOTXY_LOAD_THREADS)
+        threads = FL_PLOTXY_LOAD_THREADS;
+    if (threads < 1)
+        threads = 1;
+    parts = (int)((rows + block - 1) / block);
+    if (parts > threads)
+        parts = threads;
+
+    out_flush(O);
+    for (part = 0; part < parts; part++)
+    {
+        T[part].XL = XL;
+        T[part].Lines = lines;
+        T[part].Count = count;
+        T[part].Time = time;
+        if ((T[part].Buf = (char *)malloc(block * room)) == NULL)
+        {
+            while (part-- > 0)
+                free(T[part].Buf);
+            return (0);
+        }
+    }
 
-        finish = L->Ymax;
+    for (row = 0; row < rows;)
+    {
+        for (n = 0; n < parts && row < rows; n++)
+        {
+            T[n].First = row;
+            row = T[n].Last = rows - row < block ? rows : row + block;
+        }
 
-        if (P_DEBUG > 1)
+        for (part = 1; part < n; part++)
         {
-            printf(" Ymin=%lf, Ymax=%lf, YMarkSize=%lf, Y_Scale=%lf\n", L->Ymin, L->Ymax, L->YMarkSize, L->Y_Scale);
-            printf(" step=%lf, start=%lf, finish=%lf\n", step, start, finish);
+#ifdef WIN32
+            started[part] = (H[part] = CreateThread(NULL, 0, csv_thread, &T[part], 0, NULL)) != NULL;
+#else
+            started[part] = pthread_create(&H[part], NULL, csv_thread, &T[part]) == 0;
+#endif
         }
 
-        /* Set Line Colour */
-        fl_color(L->C);
+        csv_part(&T[0]);
 
-        if (start > finish)
+        for (part = 1; part < n; part++)
         {
-            tmp = start;
-            start = finish;
-            finish = tmp;
+            if (!started[part])
+            {
+                csv_part(&T[part]);
+                continue;
+            }
+#ifdef WIN32
+            WaitForSingleObject(H[part], INFINITE);
+            CloseHandle(H[part]);
+#else
+            pthread_join(H[part], NULL);
+#endif
         }
 
-        for (; start < finish; start += step)
+        for (part = 0; part < n; part++)
         {
-            xx = PX - 8;
-            yy = PY + PH - (int)((start + L->Y_Bottom) * L->Y_Scale);
-            fl_line(xx, yy, xx + 5, yy);
+            if (fwrite(T[part].Buf, 1, T[part].Used, O->F) != T[part].Used)
+                O->Error = 1;
+        }
 
-            /* Print Value */
-            if ((L->YMark & FL_PLOTXY_MARK_VAL))
-            {
-                switch (L->YValType)
-                {
-                default:
-                case FL_PLOTXY_VAL_NUMBER:
-                    //sprintf(str,"%0.3lf",start);
-                    sprintf(str, L->YValFormat, start);
-                    break;
+        if (more != NULL && !more(arg, row))
+            break;
+    }
 
-                case FL_PLOTXY_VAL_TIMEHM:
-                    tt = (int)start;
-                    h = tt / 3600;
-                    tt = tt - (h * 3600);
-                    m = tt / 60;
-                    sprintf(str, "%02d:%02d", h, m);
-                    break;
+    for (part = 0; part < parts; part++)
+        free(T[part].Buf);
+    return (1);
+}
 
-                case FL_PLOTXY_VAL_TIMEHMS:
-                    tt = (int)start;
-                    h = tt / 3600;
-                    tt = tt - (h * 3600);
-                    m = tt / 60;
-                    tt = tt - (m * 60);
-                    s = tt;
-                    sprintf(str, "%02d:%02d:%02d", h, m, s);
-                    break;
+/* The title rows of savexyyy, the X label then those of the lines */
+static void csv_head(Fl_PlotXY_Out *O, Fl_PlotXY_Line **lines, int count, const char *xlabel)
+{
+    int n;
 
-                case FL_PLOTXY_VAL_DATE:
-                    sprintf(str, "Date");
-                    break;
-                }
+    /* Skip first column*/
+    out_text(O, "X");
 
-                tw = 0;
-                th = 0;
-                fl_measure(str, tw, th, 1);
-                xx = xx - (tw)-2;
-                yy = yy + (th / 2);
-                fl_draw(str, xx, yy);
-            }
-        }
+    /* Write Y Line Names */
+    for (n = 0; n < count; n++)
+    {
+        out_text(O, ",");
+        out_text(O, lines[n]->title);
+    }
+    out_text(O, "\n");
+
+    /* Write X Axis titles */
+    out_text(O, xlabel);
+
+    /* Write Y Axis titles */
+    for (n = 0; n < count; n++)
+    {
+        out_text(O, ",");
+        out_text(O, lines[n]->YLabel);
     }
+    out_text(O, "\n");
+}
+
+/* X of XL is written as HH:MM:SS.hh */
+static int csv_time(const Fl_PlotXY_Line *XL)
+{
+    return (XL != NULL && (XL->XValType == FL_PLOTXY_VAL_TIMEHM || XL->XValType == FL_PLOTXY_VAL_TIMEHMS ||
+                           XL->XValType == FL_PLOTXY_VAL_TIMEHMSh));
 }
 
 /************************************************************************
-*                          draw_axislabel
+*                         save
 ************************************************************************/
-void Fl_PlotXY::draw_axislabel(Fl_PlotXY_Line *L)
+int Fl_PlotXY::save(int line, const char *FileName)
 {
-    int xx, yy, tw, th;
+    Fl_PlotXY_Out O;
+    Fl_PlotXY_Line *L;
 
-    if (P_DEBUG > 3)
-        printf("Fl_PlotXY::draw_axislabel()\n");
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::save(int line,const char *FileName)\n");
 
-    /* Set Line Colour */
-    fl_color(L->C);
+    if ((L = getselected(line)) == NULL)
+        return (0); /* Get Data */
 
-    fl_font(AxisFontFace, AxisFontSize);
+    if (!out_open(&O, FileName))
+        return (0);
 
-    if (L->Displayed == 0)
-        return;
+    out_text(&O, "X,Y\n");
 
-    fl_color(L->C);
+    /* Write data to the file */
+    if (!csv_rows(&O, L, &L, 1, 0, LoadThreads ? LoadThreads : load_cpus(), NULL, NULL))
+        O.Error = 1;
 
-    /* X AXIS LABEL */
-    if ((L->XMark & FL_PLOTXY_MARK_ON) && (L->XMark & FL_PLOTXY_MARK_LABEL) && L->XLabel != NULL)
-    {
-        xx = PX + (PW / 2);
-        //yy=PY+PH+3;
-        yy = y() + h() - 5;
+    return (out_close(&O));
+}
 
-        tw = 0;
-        th = 0;
+/************************************************************************
+*                           xyyy_lines
+* First Row is line titles - one line per comma, the first column is X
+* Second Row is Axis Labels
+************************************************************************/
+int Fl_PlotXY::xyyy_lines(const char *start, const char *end, int *lines, int columns)
+{
+    const char *p, *first, *rend, *sptr;
+    const char *XLabel, *GraphLineLabel, *YLabel;
+    int count, group;
 
-        fl_measure(L->XLabel, tw, th, 1);
+    if (P_DEBUG > 1)
+        printf(" Removing all Lines\n");
+    removeall();
 
-        xx = xx - (tw / 2);
-        //yy=yy+th+2;
+    /* Labels of the old lines are not needed any more - room for the new */
+    pool_text_reset(&Pool);
 
-        // if(L->XMark & FL_PLOTXY_MARK_VAL) /* If values displayed as well - Add text height */
-        // {
-        //  yy+=th+2;
-        // }
+    if (P_DEBUG > 1)
+        printf(" Reading and decoding Line Titles\n");
 
-        fl_draw(L->XLabel, xx, yy);
+    for (count = 0; count < columns; count++)
+        lines[count] = -1; /* Clear all line values */
 
-        //printf("X=%d, Y=%d, Label=\"%s\"\n",xx,yy,L->XLabel);
+    /* First Column is X Axis - Skip it, the remaining are Line Labels */
+    first = start;
+    rend = row_end(first, end, &p);
+    sptr = (const char *)memchr(first, ',', rend - first);
+    for (count = 0; count < columns && sptr != NULL; count++)
+    {
+        sptr++;
+        GraphLineLabel = load_label(&Pool, sptr, rend, ",\r");
+
+        /* Create the Line */
+        lines[count] = newline(0, 0, 0, 0, FL_PLOTXY_AUTO, FL_BLACK, GraphLineLabel);
+
+        if (P_DEBUG > 0)
+            printf(" Line label %d = %s \n", lines[count], GraphLineLabel);
+
+        sptr = (const char *)memchr(sptr, ',', rend - sptr);
     }
 
-    /* Y AXIS LABEL */
-    if ((L->YMark & FL_PLOTXY_MARK_ON) && (L->YMark & FL_PLOTXY_MARK_LABEL) && L->YLabel != NULL)
-    {
-        //xx=PX-AxisTextSpaceY-2;
-        xx = x() + 4;
+    /* X is stored once for all the lines */
+    group = newgroup(columns, lines);
 
-        yy = PY + (PH / 2);
+    /* Second Row is Axis Labels */
+    first = p;
+    rend = row_end(first, end, &p);
 
-        tw = 0;
-        th = 0;
-        fl_measure(L->YLabel, tw, th, 1);
+    /* First Column is X Axis */
+    XLabel = load_label(&Pool, first, rend, ",\r");
 
-        //xx=xx-th-2;
-        xx += th;
-        yy = yy + (tw / 2);
+    if (P_DEBUG > 1)
+        printf(" X Title = %s \n", XLabel);
 
-/* Draw Y Label - Wrapped  THIS NEEDS WORK - Should be rotated 90 degrees!!*/
-#ifdef WIN32
+    /* Remaining Titles are Y Axis Columns */
+    sptr = (const char *)memchr(first, ',', rend - first);
+    for (count = 0; count < columns && sptr != NULL; count++)
+    {
+        sptr++;
+        YLabel = load_label(&Pool, sptr, rend, ",\r");
 
-#else
-        draw_rotated(L->YLabel, xx, yy, 90);
-#endif
+        if (P_DEBUG > 1)
+            printf(" Y Title = %s \n", YLabel);
+
+        if (P_DEBUG > 1)
+            printf(" Adding Label to line\n");
+        ymarklabel(lines[count], YLabel);
+        xmarklabel(lines[count], XLabel);
+
+        sptr = (const char *)memchr(sptr, ',', rend - sptr);
     }
+
+    return (group);
 }
 
 /************************************************************************
-*                          draw_linelabel
+*                           loadxyyy
+* Load using first column as X and remaining columns as Y data
+* Every column after the first becomes a line, all sharing the X
+* First Row is treated as titles for each Axis
+* NOTE: This will Clear ALL data dbefore Loading.
 ************************************************************************/
-void Fl_PlotXY::draw_linelabel(Fl_PlotXY_Line *L)
+int Fl_PlotXY::loadxyyy(const char *Filename)
 {
-    int xx, yy, tw = 0, th = 0;
-
-    if (P_DEBUG > 2)
-        printf("Fl_PlotXY::draw_linelabel()\n");
+    Fl_PlotXY_File F;
+    Fl_PlotXY_Rows *R;
+    const char *rows;
+    int columns, group, parts, time;
+    int *lines;
+    unsigned long int count;
+    const double **ys;
 
-    if (P_DEBUG > 2)
-        printf(" Processing Line %d\n", L->LineNumber);
+    if (P_DEBUG > 0)
+        printf("Fl_PlotXY::loadxyyy(const char *Filename)\n");
 
-    if (L->Displayed == 0)
+    if (P_DEBUG > 1)
+        printf(" Opening file %s\n", Filename);
+    if (!file_open(&F, Filename, 1))
     {
-        if (P_DEBUG > 2)
-            printf(" Line %d Not displayed!\n", L->LineNumber);
-        return;
+        if (P_DEBUG > 1)
+            printf(" ERROR: Could not open %s\n", Filename);
+        return (0);
     }
 
-    if (L->XMark & FL_PLOTXY_MARK_NAME != 0)
+    columns = xyyy_columns(F.Data, F.Data + F.Size, &rows);
+    lines = (int *)malloc((columns + 1) * sizeof(int));
+    ys = (const double **)malloc((columns + 1) * sizeof(double *));
+    if (lines == NULL || ys == NULL)
     {
-        fl_font(AxisFontFace, AxisFontSize);
-
-        fl_color(L->C);
-
-        fl_measure(L->title, tw, th, 1);
+        if (P_DEBUG > 1)
+            printf(" ERROR: Out of memory\n");
+        free(lines);
+        free(ys);
+        file_close(&F);
+        return (0);
+    }
 
-        xx = PX + PW - tw - 4;
-        yy = PY + 5 + ((L->LineNumber + 1) * (th + 2));
+    if (P_DEBUG > 1)
+        printf(" File opened Sucessfully\n");
+    group = xyyy_lines(F.Data, F.Data + F.Size, lines, columns);
 
-        fl_draw(L->title, xx, yy);
+    if (P_DEBUG > 1)
+        printf(" Reading Line Data\n");
 
-        if (P_DEBUG > 2)
-            printf(" X=%d, Y=%d, Title= %s\n", xx, yy, L->title);
-    }
-    else
+    /* Parse the parts of the file, then add their rows in order */
+    if ((R = rows_split(rows, F.Data + F.Size, 0, columns, LoadThreads ? LoadThreads : load_cpus(), &parts)) == NULL)
     {
-        if (P_DEBUG > 2)
-            printf(" Title Not enabled!");
+        if (P_DEBUG > 1)
+            printf(" ERROR: Out of memory\n");
+        parts = 0;
     }
-}
+    rows_run(R, parts);
 
-/***********************************************************************
-*                         draw_vline
-***********************************************************************/
-void Fl_PlotXY::draw_vline(Fl_PlotXY_Line *L)
-{
-    char str[20];
-    int xx, yy, tw, th;
-    Fl_PlotXY_Data *TempData;
+    /* Room for a row a line */
+    if (group >= 0 && (count = rows_size(R, parts)) > 0)
+        group_grow(Groups[group], count);
 
-    if (P_DEBUG > 3)
-        printf("Fl_PlotXY::draw_vline(Fl_PlotXY_Line* L)\n");
+    time = rows_add(this, group, R, parts, ys);
 
-    TempData = L->data;
+    /* Set X Axis Value Mode */
+    xyyy_marks(this, lines, columns, time);
 
-    /* Check for Data */
-    if (TempData == NULL)
-        return;
+    free(lines);
+    free(ys);
+    file_close(&F);
 
-    if (VLinePos >= L->DataSize)
-        VLinePos = L->DataSize;
-    TempData += VLinePos;
+    redraw();
 
-    /* Get Data*/
+    return (1);
+}
 
-    xx = PX + (int)((TempData->X + L->X_Left) * L->X_Scale);
-    yy = PY + PH - (int)((TempData->Y + L->Y_Bottom) * L->Y_Scale);
+/************************************************************************
+*                           savexyyy
+* save using first column as X and remaining columns as Y data
+* This scans for the Maximum number of Y columns
+* First Row is titles for each Axis
+************************************************************************/
+int Fl_PlotXY::savexyyy(const char *Filename)
+{
+    Fl_PlotXY_Out O;
+    int count, used_lines;
+    Fl_PlotXY_Line *L, *XL, **lines;
 
-    /* Set Line Colour */
-    fl_color(fl_lighter(L->C));
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::savexyyy(const char *Filename)\n");
 
-    /* Draw the vertical line */
-    fl_line(xx, PY, xx, PY + PH);
+    if (P_DEBUG > 1)
+        printf(" Opening file %s\n", Filename);
+    if (!out_open(&O, Filename))
+    {
+        if (P_DEBUG > 1)
+            printf(" ERROR: Could not open %s\n", Filename);
+        return (0);
+    }
 
-    /* Draw the circle */
-    fl_circle(xx, yy, 5);
+    /* Work out the lines to write once, not for every value */
+    if ((lines = (Fl_PlotXY_Line **)malloc((LineSlots + 1) * sizeof(Fl_PlotXY_Line *))) == NULL)
+    {
+        out_close(&O);
+        return (0);
+    }
+    used_lines = 0;
+    for (count = 0; count < LineSlots; count++)
+    {
+        if ((L = getselected(count)) != NULL)
+            lines[used_lines++] = L;
+    }
+    XL = getselected(0); /* X values come from line 0 */
 
-    /* Draw the value amount */
-    sprintf(str, L->YValFormat, TempData->Y);
+    csv_head(&O, lines, used_lines, xmarklabel(0));
 
-    fl_font(AxisFontFace, AxisFontSize);
-    //fl_color(L->C);
-    //fl_measure(str,tw,th,1);
+    /* Write the X, Y values */
+    if (!csv_rows(&O, XL, lines, used_lines, csv_time(XL), LoadThreads ? LoadThreads : load_cpus(), NULL, NULL))
+        O.Error = 1;
 
-    fl_draw(str, xx + 5, yy);
+    free(lines);
+    return (out_close(&O));
 }
 
 /************************************************************************
-*                            minmax
-* Min/Max calcute for auto scaling
+*                          Binary .pxy files
+* A header, a record for each line, the label strings, then the values
+* of each column and the pyramid levels, each on a multiple of
+* FL_PLOTXY_PXY_ALIGN bytes. Every 8 byte field is on a multiple of 8
+* so the layout is the same from any compiler.
 ************************************************************************/
-void Fl_PlotXY::minmax(Fl_PlotXY_Line *L)
+typedef struct
 {
-    Fl_PlotXY_Data *TempData;
-    unsigned long int count;
-
-    if (P_DEBUG > 3)
-        printf("Fl_PlotXY::minmax()\n");
+    char Magic[8];                /* FL_PLOTXY_PXY_MAGIC */
+    unsigned int Version;         /* FL_PLOTXY_PXY_VERSION it was written by */
+    unsigned int Order;           /* 0x01020304 as written - the byte order */
+    unsigned int Lines;           /* Line records after the header */
+    unsigned int LineSize;        /* Bytes in a line record, later versions add to the end */
+    unsigned long long Size;      /* Bytes in the file */
+    unsigned long long Spare[4];
+} Fl_PlotXY_PxyHeader;
+
+/* A column as stored - the values packed, in the order of the points */
+typedef struct
+{
+    unsigned long long At;    /* File offset of the first value, 0 if none stored */
+    unsigned long long Bytes; /* Bytes of values */
+    double Gain, Offset;      /* Integer scaling, or step and first X of uniform X */
+    int Type;                 /* FL_PLOTXY_DOUBLE .. FL_PLOTXY_UNIFORM */
+    int Spare;
+} Fl_PlotXY_PxyColumn;
+
+typedef struct
+{
+    unsigned long long Points;                             /* Points in the line */
+    unsigned long long Text[3];                            /* Title, X and Y label - file offsets, 0 if none */
+    unsigned long long Pyramid[FL_PLOTXY_PYRAMID_LEVELS]; /* File offset of each level, 0 if none */
+    unsigned long long Blocks[FL_PLOTXY_PYRAMID_LEVELS];  /* Blocks on each level */
+    double Xmin, Xmax, Ymin, Ymax;                         /* Axis range */
+    double DataXmin, DataXmax, DataYmin, DataYmax;         /* Range of the points, if Bounds */
+    double XMarkSize, YMarkSize, StripSpan;
+    Fl_PlotXY_PxyColumn X, Y;
+    int DrawMode, ScaleMode, Displayed, XMark, YMark, XValType, YValType, Bounds;
+    unsigned int Color;
+    int Spare;
+    char XValFormat[16], YValFormat[16];
+} Fl_PlotXY_PxyLine;
+
+/* A loaded file, let go by the last line showing it */
+typedef struct
+{
+    Fl_PlotXY_File F;
+    int Users;
+} Fl_PlotXY_Map;
 
-    /* Use Temp Pointer to data */
-    TempData = L->data;
+static void map_release(void *arg)
+{
+    Fl_PlotXY_Map *M = (Fl_PlotXY_Map *)arg;
 
-    if (TempData != NULL)
+    if (--M->Users == 0)
     {
-        /* Use First Values as Reference */
-        MinX = MaxX = TempData->X;
-        MinY = MaxY = TempData->Y;
+        file_close(&M->F);
+        free(M);
+    }
+}
 
-        /* Scan Data for Min/Max X and Min/Max Y values */
-        for (count = 0; count < L->DataSize; count++)
-        {
+/* Bytes to the next multiple of FL_PLOTXY_PXY_ALIGN */
+static inline unsigned long long pxy_pad(unsigned long long at)
+{
+    return ((FL_PLOTXY_PXY_ALIGN - at % FL_PLOTXY_PXY_ALIGN) % FL_PLOTXY_PXY_ALIGN);
+}
+
+/* Write n bytes, moving *at on - 0 on a write error */
+static int pxy_write(FILE *fptr, const void *d, unsigned long long n, unsigned long long *at)
+{
+    static const char zero[FL_PLOTXY_PXY_ALIGN] = {0};
 
-            if (MinX > TempData->X)
-                MinX = TempData->X;
-            if (MaxX < TempData->X)
-                MaxX = TempData->X;
+    *at += n;
+    return (n == 0 || fwrite(d != NULL ? d : zero, (size_t)n, 1, fptr) == 1);
+}
+
+/* Write a column's values packed, a run of points at a time */
+static int pxy_column(FILE *fptr, const Fl_PlotXY_Line *L, const Fl_PlotXY_Column *C, unsigned long long *at)
+{
+    char buf[4096];
+    unsigned long int first, n, p, count, c;
+    int size = col_size(C->Type);
+
+    for (first = 0; first < L->DataSize; first += n)
+    {
+        n = line_run(L, first, L->DataSize, &p);
+        if (C->Stride == size)
+        {
+            if (!pxy_write(fptr, col_at(C, p), (unsigned long long)n * size, at))
+                return (0);
+            continue;
+        }
 
-            if (MinY > TempData->Y)
-                MinY = TempData->Y;
-            if (MaxY < TempData->Y)
-                MaxY = TempData->Y;
-            TempData++;
+        /* Interleaved with the other column - gather the values */
+        for (count = 0; count < n; count += c)
+        {
+            for (c = 0; c < n - count && c < sizeof(buf) / size; c++)
+                memcpy(buf + c * size, col_at(C, p + count + c), size);
+            if (!pxy_write(fptr, buf, (unsigned long long)c * size, at))
+                return (0);
         }
+    }
+    return (1);
+}
+
+/* Describe a column, stored at *at if it stores values */
+static void pxy_describe(Fl_PlotXY_PxyColumn *R, const Fl_PlotXY_Line *L, const Fl_PlotXY_Column *C, unsigned long long *at)
+{
+    R->Type = C->Type;
+    R->Gain = C->Gain;
+    R->Offset = C->Offset;
+    R->At = R->Bytes = 0;
 
-        L->Xmin = MinX;
-        L->Xmax = MaxX;
-        L->Ymin = MinY;
-        L->Ymax = MaxY;
+    if (C->Type == FL_PLOTXY_UNIFORM)
+    {
+        /* X of the oldest point, numbered from 0 again */
+        R->Offset = C->Offset + C->Gain * C->Base;
+        return;
     }
+
+    R->At = *at;
+    R->Bytes = (unsigned long long)L->DataSize * col_size(C->Type);
+    *at += R->Bytes + pxy_pad(R->Bytes);
 }
 
 /************************************************************************
-*                            setscale
-* Set up zoom scale etc
+*                          savepxy
+* Where everything goes is worked out first, then it is written in
+* that order.
 ************************************************************************/
-void Fl_PlotXY::setscale(Fl_PlotXY_Line *L)
+int Fl_PlotXY::savepxy(const char *Filename)
 {
-    double mx, MX, my, MY;
-
-    if (P_DEBUG > 1)
-        printf("Fl_PlotXY::setscale(Fl_PlotXY_Line* L)\n");
+    FILE *fptr;
+    Fl_PlotXY_PxyHeader H;
+    Fl_PlotXY_PxyLine *R;
+    Fl_PlotXY_Line *L;
+    Fl_PlotXY_Pyramid *P;
+    unsigned long long at, *groupx;
+    const char *text[3];
+    int count, used_lines, t, level, ok = 1;
 
-    /* Ensure Min and Max values are correct */
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::savepxy(const char *Filename)\n");
 
-    if (L->Xmax > L->Xmin)
-    {
-        mx = L->Xmin;
-        MX = L->Xmax;
-    }
-    else
+    R = (Fl_PlotXY_PxyLine *)calloc(LineSlots + 1, sizeof(Fl_PlotXY_PxyLine));
+    groupx = (unsigned long long *)calloc(GroupSlots + 1, sizeof(unsigned long long));
+    if (R == NULL || groupx == NULL)
     {
-        mx = L->Xmax;
-        MX = L->Xmin;
+        free(R);
+        free(groupx);
+        return (0);
     }
 
-    if (L->Ymax > L->Ymin)
-    {
-        my = L->Ymin;
-        MY = L->Ymax;
-    }
-    else
+    /* Line records, then the labels */
+    for (count = 0, used_lines = 0; count < LineSlots; count++)
+        if (getselected(count) != NULL)
+            used_lines++;
+    at = sizeof(H) + (unsigned long long)used_lines * sizeof(Fl_PlotXY_PxyLine);
+
+    for (count = 0, used_lines = 0; count < LineSlots; count++)
     {
-        my = L->Ymax;
-        MY = L->Ymin;
+        if ((L = getselected(count)) == NULL)
+            continue;
+
+        text[0] = L->title;
+        text[1] = L->XLabel;
+        text[2] = L->YLabel;
+        for (t = 0; t < 3; t++)
+        {
+            if (text[t] == NULL)
+                continue;
+            R[used_lines].Text[t] = at;
+            at += strlen(text[t]) + 1;
+        }
+        used_lines++;
     }
+    at += pxy_pad(at);
 
-    /* Calculate the Multiplyer for scaling */
-    if ((MX - mx) != 0)
+    /* Then the values and pyramid of each line */
+    for (count = 0, used_lines = 0; count < LineSlots; count++)
     {
-        L->X_Scale = (double)(PW) / (MX - mx);
+        if ((L = getselected(count)) == NULL)
+            continue;
+
+        pxy_describe(&R[used_lines].X, L, &L->XCol, &at);
+        if (L->Group != NULL && groupx[L->Group->Number] != 0)
+        {
+            /* A group's X once, with its first line */
+            at = R[used_lines].X.At;
+            R[used_lines].X.At = groupx[L->Group->Number];
+        }
+        else if (L->Group != NULL)
+            groupx[L->Group->Number] = R[used_lines].X.At;
+        pxy_describe(&R[used_lines].Y, L, &L->YCol, &at);
+
+        if ((P = L->Pyramid) != NULL && L->DataSize != 0)
+        {
+            for (level = 0; level < FL_PLOTXY_PYRAMID_LEVELS; level++)
+            {
+                R[used_lines].Pyramid[level] = at;
+                R[used_lines].Blocks[level] = P->Size[level];
+                at += P->Size[level] * sizeof(Fl_PlotXY_Block);
+                at += pxy_pad(at);
+            }
+        }
+
+        R[used_lines].Points = L->DataSize;
+        R[used_lines].Xmin = L->Xmin;
+        R[used_lines].Xmax = L->Xmax;
+        R[used_lines].Ymin = L->Ymin;
+        R[used_lines].Ymax = L->Ymax;
+        R[used_lines].Bounds = L->BoundsValid;
+        if (L->BoundsValid)
+        {
+            R[used_lines].DataXmin = L->DataXmin;
+            R[used_lines].DataXmax = L->DataXmax;
+            R[used_lines].DataYmin = L->DataYmin;
+            R[used_lines].DataYmax = L->DataYmax;
+        }
+        R[used_lines].XMarkSize = L->XMarkSize;
+        R[used_lines].YMarkSize = L->YMarkSize;
+        R[used_lines].StripSpan = L->StripSpan;
+        R[used_lines].DrawMode = L->DrawMode;
+        R[used_lines].ScaleMode = L->ScaleMode;
+        R[used_lines].Displayed = L->Displayed;
+        R[used_lines].XMark = L->XMark;
+        R[used_lines].YMark = L->YMark;
+        R[used_lines].XValType = L->XValType;
+        R[used_lines].YValType = L->YValType;
+        R[used_lines].Color = (unsigned int)L->C;
+        strncpy(R[used_lines].XValFormat, L->XValFormat, sizeof(R[used_lines].XValFormat) - 1);
+        strncpy(R[used_lines].YValFormat, L->YValFormat, sizeof(R[used_lines].YValFormat) - 1);
+        used_lines++;
     }
-    else
+
+    memset(&H, 0, sizeof(H));
+    memcpy(H.Magic, FL_PLOTXY_PXY_MAGIC, sizeof(H.Magic));
+    H.Version = FL_PLOTXY_PXY_VERSION;
+    H.Order = 0x01020304;
+    H.Lines = used_lines;
+    H.LineSize = sizeof(Fl_PlotXY_PxyLine);
+    H.Size = at;
+
+    if (P_DEBUG > 1)
+        printf(" Opening file %s\n", Filename);
+    if ((fptr = fopen(Filename, "wb")) == NULL)
     {
-        /* If a divide by zero would occur - set scale to 1 */
-        L->X_Scale = 1;
+        if (P_DEBUG > 1)
+            printf(" ERROR: Could not open %s\n", Filename);
+        free(R);
+        free(groupx);
+        return (0);
     }
+    setvbuf(fptr, NULL, _IOFBF, 1 << 20);
 
-    if ((MY - my) != 0)
+    /* Write it all in the same order */
+    at = 0;
+    ok = pxy_write(fptr, &H, sizeof(H), &at) &&
+         pxy_write(fptr, R, (unsigned long long)used_lines * sizeof(Fl_PlotXY_PxyLine), &at);
+
+    for (count = 0; ok && count < LineSlots; count++)
     {
-        L->Y_Scale = (double)(PH) / (MY - my);
+        if ((L = getselected(count)) == NULL)
+            continue;
+        text[0] = L->title;
+        text[1] = L->XLabel;
+        text[2] = L->YLabel;
+        for (t = 0; ok && t < 3; t++)
+            if (text[t] != NULL)
+                ok = pxy_write(fptr, text[t], strlen(text[t]) + 1, &at);
     }
-    else
+    ok = ok && pxy_write(fptr, NULL, pxy_pad(at), &at);
+
+    for (count = 0, used_lines = 0; ok && count < LineSlots; count++)
     {
-        /* If a divide by zero would occur - set scale to 1 */
-        L->Y_Scale = 1;
+        if ((L = getselected(count)) == NULL)
+            continue;
+
+        if (R[used_lines].X.At == at)
+            ok = pxy_column(fptr, L, &L->XCol, &at) && pxy_write(fptr, NULL, pxy_pad(at), &at);
+        if (ok && R[used_lines].Y.At == at)
+            ok = pxy_column(fptr, L, &L->YCol, &at) && pxy_write(fptr, NULL, pxy_pad(at), &at);
+
+        for (level = 0; ok && level < FL_PLOTXY_PYRAMID_LEVELS && R[used_lines].Pyramid[level] != 0; level++)
+            ok = pxy_write(fptr, L->Pyramid->Level[level], R[used_lines].Blocks[level] * sizeof(Fl_PlotXY_Block), &at) &&
+                 pxy_write(fptr, NULL, pxy_pad(at), &at);
+        used_lines++;
     }
 
-    /* Calculate the Shift for X and Y */
-    /* 0 minus lowest value give amout to Add to put at top/bottom */
-    L->X_Left = 0.0 - mx;
-    L->Y_Bottom = 0.0 - my;
+    ok = ok && at == H.Size;
+    if (fclose(fptr) != 0)
+        ok = 0;
+    free(R);
+    free(groupx);
 
-    if (P_DEBUG > 1)
-    {
-        printf(" X_Scale=%lf\n Y_Scale=%lf\n", L->X_Scale, L->Y_Scale);
-        printf(" X_Left=%lf\n Y_Bottom=%lf\n", L->X_Left, L->Y_Bottom);
-    }
+    if (!ok && P_DEBUG > 1)
+        printf(" ERROR: Could not write %s\n", Filename);
+    return (ok);
+}
+
+/* Values of a stored column, NULL if they are not all in the file */
+static const char *pxy_values(const Fl_PlotXY_File *F, const Fl_PlotXY_PxyColumn *C, unsigned long long points)
+{
+    if (C->Type < FL_PLOTXY_DOUBLE || C->Type > FL_PLOTXY_INT32 || C->At % sizeof(double) != 0 ||
+        C->At > F->Size || C->Bytes > F->Size - C->At || points > C->Bytes / col_size(C->Type))
+        return (NULL);
+    return (F->Data + C->At);
+}
+
+/* A label in the file, copied to the pool */
+static const char *pxy_text(Fl_PlotXY_Pool *P, const Fl_PlotXY_File *F, unsigned long long at)
+{
+    const char *t, *e;
+
+    if (at == 0 || at >= F->Size || (e = (const char *)memchr(F->Data + at, 0, F->Size - at)) == NULL)
+        return ("");
+    t = pool_string(P, F->Data + at, e - (F->Data + at));
+    return (t != NULL ? t : "");
+}
+
+/* A value format the same as xvalformat would make, or the default */
+static void pxy_format(char *to, const char *from)
+{
+    int whole, points;
+    char end;
+
+    if (sscanf(from, "%%0%d.0%dl%c", &whole, &points, &end) == 3 && end == 'f' &&
+        whole >= 0 && whole < 10 && points >= 0 && points < 10)
+        sprintf(to, "%%0%d.0%dlf", whole, points);
+    else
+        sprintf(to, "%%0.02lf");
 }
 
 /************************************************************************
-*                          load
-*
-* Loads Comma Separated Value (CSV) File from Disk
-* Data MUST be arranged as X,Y
-* Any NON Numerical data is Not added to the graph.
-* Returns 1 on sucess 0 on failure
+*                          loadpxy
+* Each line attaches to its values in the mapped file and borrows its
+* pyramid from there too
 ************************************************************************/
-int Fl_PlotXY::load(const char *FileName)
+int Fl_PlotXY::loadpxy(const char *Filename)
 {
+    Fl_PlotXY_Map *M;
+    Fl_PlotXY_PxyHeader H;
+    Fl_PlotXY_PxyLine R;
     Fl_PlotXY_Line *L;
-    int line;
-    unsigned int tmp;
-    char str[255];
-    double X, Y;
-    FILE *fptr;
+    Fl_PlotXY_Pyramid *P;
+    const char *X, *Y;
+    unsigned long long blocks;
+    unsigned int count;
+    int line, level;
 
-    if (P_DEBUG > 2)
-        printf("Fl_PlotXY::load(int,char*)\n");
+    if (P_DEBUG > 0)
+        printf("Fl_PlotXY::loadpxy(const char *Filename)\n");
 
-    /* Create New line */
-    if ((line = newline()) == -1)
-        return (-1);
-    if ((fptr = fopen(FileName, "r")) == NULL)
-        return (-1);
+    if ((M = (Fl_PlotXY_Map *)malloc(sizeof(Fl_PlotXY_Map))) == NULL)
+        return (0);
+    if (!file_open(&M->F, Filename, 0))
+    {
+        if (P_DEBUG > 1)
+            printf(" ERROR: Could not open %s\n", Filename);
+        free(M);
+        return (0);
+    }
+    M->Users = 1; /* Until all the lines have it */
+
+    /* Check it is a file this can read */
+    if (M->F.Size >= sizeof(H))
+        memcpy(&H, M->F.Data, sizeof(H));
+    if (M->F.Size < sizeof(H) || memcmp(H.Magic, FL_PLOTXY_PXY_MAGIC, sizeof(H.Magic)) != 0 ||
+        H.Order != 0x01020304 || H.Version > FL_PLOTXY_PXY_VERSION || H.LineSize < sizeof(R) ||
+        H.Size != M->F.Size || H.Lines > (M->F.Size - sizeof(H)) / H.LineSize)
+    {
+        if (P_DEBUG > 1)
+            printf(" ERROR: %s is not a .pxy file this can read\n", Filename);
+        map_release(M);
+        return (0);
+    }
+
+    removeall();
+
+    /* Labels of the old lines are not needed any more - room for the new */
+    pool_text_reset(&Pool);
 
-    while (!feof(fptr))
+    for (count = 0; count < H.Lines; count++)
     {
-        /* Read a Line */
-        fgets(str, 255, fptr);
+        memcpy(&R, M->F.Data + sizeof(H) + (unsigned long long)count * H.LineSize, sizeof(R));
 
-        /* Check if it is numbers or characters */
-        if ((str[0] >= '0' && str[0] <= '9') || str[0] == '-')
+        X = pxy_values(&M->F, &R.X, R.Points);
+        if ((Y = pxy_values(&M->F, &R.Y, R.Points)) == NULL || R.Points > (unsigned long int)-1 ||
+            (X == NULL && (R.X.Type != FL_PLOTXY_UNIFORM || R.X.Gain == 0.0 || R.X.Gain != R.X.Gain)))
         {
-            /* Process the Line */
-            X = atof(str);
-            tmp = 0;
-            while (tmp < strlen(str))
-            {
-                switch (str[tmp])
-                {
-                case ',':
-                    Y = atof(&str[tmp + 1]);
-                    add(line, X, Y);
+            if (P_DEBUG > 1)
+                printf(" ERROR: Line %u values are not all in the file\n", count);
+            continue;
+        }
 
-                case 0:
-                    tmp = strlen(str) + 1;
-                    break;
+        if ((line = newline(R.Xmin, R.Ymin, R.Xmax, R.Ymax, R.ScaleMode, (Fl_Color)R.Color,
+                            pxy_text(&Pool, &M->F, R.Text[0]))) == -1 ||
+            (L = getselected(line)) == NULL)
+            break;
 
-                default:
-                    tmp++;
-                    break;
-                }
+        /* Show the values where they are */
+        L->XCol.Type = X != NULL ? R.X.Type : FL_PLOTXY_UNIFORM;
+        L->XCol.Gain = R.X.Gain;
+        L->XCol.Offset = R.X.Offset;
+        L->YCol.Gain = R.Y.Gain;
+        L->YCol.Offset = R.Y.Offset;
+        M->Users++;
+        if (!attach(line, (unsigned long int)R.Points, X, R.X.Type, 0, Y, R.Y.Type, 0, map_release, M))
+        {
+            M->Users--;
+            remove(line);
+            continue;
+        }
+
+        L->DrawMode = R.DrawMode;
+        L->XMark = R.XMark;
+        L->YMark = R.YMark;
+        L->XMarkSize = R.XMarkSize;
+        L->YMarkSize = R.YMarkSize;
+        L->XValType = R.XValType;
+        L->YValType = R.YValType;
+        L->StripSpan = R.StripSpan;
+        L->XLabel = pxy_text(&Pool, &M->F, R.Text[1]);
+        L->YLabel = pxy_text(&Pool, &M->F, R.Text[2]);
+        R.XValFormat[sizeof(R.XValFormat) - 1] = 0;
+        R.YValFormat[sizeof(R.YValFormat) - 1] = 0;
+        pxy_format(L->XValFormat, R.XValFormat);
+        pxy_format(L->YValFormat, R.YValFormat);
+        if (!R.Displayed)
+            showlist(L, 0);
+
+        /* The range saved saves scanning the points */
+        if (R.Bounds && R.Points != 0)
+        {
+            L->DataXmin = R.DataXmin;
+            L->DataXmax = R.DataXmax;
+            L->DataYmin = R.DataYmin;
+            L->DataYmax = R.DataYmax;
+            L->BoundsValid = 1;
+        }
+
+        /* Borrow the pyramid if every level is there and the right size */
+        for (level = 0; level < FL_PLOTXY_PYRAMID_LEVELS; level++)
+        {
+            blocks = (R.Points + (1ULL << (FL_PLOTXY_PYRAMID_SHIFT * (level + 1))) - 1) >> (FL_PLOTXY_PYRAMID_SHIFT * (level + 1));
+            if (R.Pyramid[level] == 0 || R.Pyramid[level] % sizeof(double) != 0 || R.Blocks[level] != blocks ||
+                R.Pyramid[level] > M->F.Size || blocks > (M->F.Size - R.Pyramid[level]) / sizeof(Fl_PlotXY_Block))
+                break;
+        }
+        if (level == FL_PLOTXY_PYRAMID_LEVELS && R.Points != 0 &&
+            (P = (Fl_PlotXY_Pyramid *)calloc(1, sizeof(Fl_PlotXY_Pyramid))) != NULL)
+        {
+            for (level = 0; level < FL_PLOTXY_PYRAMID_LEVELS; level++)
+            {
+                P->Level[level] = (Fl_PlotXY_Block *)(M->F.Data + R.Pyramid[level]);
+                P->Size[level] = P->Capacity[level] = (unsigned long int)R.Blocks[level];
             }
+            P->Mapped = 1;
+            pyramid_free(L);
+            L->Pyramid = P;
         }
     }
 
-    fclose(fptr);
-
-    if ((L = getselected(line)) == NULL)
-        return (-1);
-    minmax(L);
+    map_release(M);
 
     redraw();
-    return (line);
+
+    return (1);
 }
 
 /************************************************************************
-*                         save
+*                          Background jobs
+* loadasync, loadxyyyasync, saveasync and savexyyyasync run on a thread
+* of their own. The thread only reads the file, or copies of the lines
+* made before it starts, and tells async_step on the FLTK thread what
+* it has done through Fl::awake. Parsed rows are added to the lines
+* there, so the widget only changes on the thread that draws it.
 ************************************************************************/
-int Fl_PlotXY::save(int line, const char *FileName)
+#define FL_PLOTXY_ASYNC_PART (4 * FL_PLOTXY_LOAD_SPLIT) /* Bytes a thread parses between reports */
+
+#define FL_PLOTXY_JOB_LOAD 0     /* load, X,Y rows */
+#define FL_PLOTXY_JOB_LOADXYYY 1 /* loadxyyy */
+#define FL_PLOTXY_JOB_SAVE 2     /* save or savexyyy */
+
+/* Rows parsed in one go, waiting to be added */
+typedef struct Fl_PlotXY_Round
 {
-    FILE *fptr;
-    unsigned long int cnt;
-    Fl_PlotXY_Line *L;
-    Fl_PlotXY_Data *D;
+    struct Fl_PlotXY_Round *Next;
+    Fl_PlotXY_Rows *R;
+    int Parts;
+} Fl_PlotXY_Round;
 
-    if (P_DEBUG > 2)
-        printf("Fl_PlotXY::save(int line,const char *FileName)\n");
+struct Fl_PlotXY_Job
+{
+    Fl_PlotXY *W;           /* Widget, NULL once it has gone */
+    Fl_Awake_Handler Awake; /* Fl_PlotXY::async_awake */
+    int Kind;               /* FL_PLOTXY_JOB_... */
+    int Threads;            /* Most threads to parse or write on */
+
+    /* Loading */
+    Fl_PlotXY_File F;
+    int Open;             /* F is open */
+    const char *Rows;     /* First row of values */
+    int Columns;          /* Y values a row */
+    int Line;             /* Line of load */
+    int *Lines;           /* Lines of loadxyyy, one a column */
+    int Group;            /* Group of loadxyyy */
+    int Made;             /* The lines are ready for rows */
+    const double **Ys;    /* Y pointer a line for add_rows */
+    int Time;             /* Some X were HH:MM:SS */
+
+    /* Saving */
+    char *Name;             /* Removed if cancelled */
+    Fl_PlotXY_Out O;
+    Fl_PlotXY_Line **Copies; /* Copies of the lines saved */
+    int Copied;
+    Fl_PlotXY_Line *XL;      /* The copy X comes from, NULL if none */
+    int XTime;               /* X is written as HH:MM:SS.hh */
+
+    /* Shared with the thread, under Lock */
+    Fl_PlotXY_Round *Head, *Tail; /* Parsed rows not taken yet */
+    unsigned long int Points;     /* Rows in the file */
+    unsigned long int Done;       /* Bytes parsed or rows written */
+    unsigned long int Total;      /* Of them all */
+    int Cancel;                   /* asynccancel was called */
+    int State;                    /* FL_PLOTXY_ASYNC_... */
+    int Posted;                   /* Awake is still to be called */
+#ifdef WIN32
+    CRITICAL_SECTION Lock;
+    HANDLE Thread;
+#else
+    pthread_mutex_t Lock;
+    pthread_t Thread;
+#endif
+};
 
-    if ((L = getselected(line)) == NULL)
-        return (0); /* Get Data */
+static void job_lock(Fl_PlotXY_Job *J)
+{
+#ifdef WIN32
+    EnterCriticalSection(&J->Lock);
+#else
+    pthread_mutex_lock(&J->Lock);
+#endif
+}
+
+static void job_unlock(Fl_PlotXY_Job *J)
+{
+#ifdef WIN32
+    LeaveCriticalSection(&J->Lock);
+#else
+    pthread_mutex_unlock(&J->Lock);
+#endif
+}
+
+/* Have Awake called on the FLTK thread, once for any number of calls
+ * before it is - with the lock held */
+static void job_post(Fl_PlotXY_Job *J)
+{
+    if (!J->Posted && J->W != NULL && Fl::awake(J->Awake, J) == 0)
+        J->Posted = 1;
+}
+
+static void rounds_free(Fl_PlotXY_Round *N)
+{
+    Fl_PlotXY_Round *next;
+
+    for (; N != NULL; N = next)
+    {
+        next = N->Next;
+        rows_free(N->R, N->Parts);
+        free(N);
+    }
+}
 
-    D = L->data; /* Pointer to data */
+/* Points of a line copied for a save */
+static void line_uncopy(Fl_PlotXY_Line *S)
+{
+    if (S == NULL)
+        return;
+    free(S->XCol.Data);
+    free(S->YCol.Data);
+    free(S);
+}
 
-    if ((fptr = fopen(FileName, "w")) == NULL)
+/* Column C of L into D, oldest value first, one after another */
+static int col_copy(Fl_PlotXY_Column *D, const Fl_PlotXY_Column *C, const Fl_PlotXY_Line *L)
+{
+    unsigned long int first, n, p, count;
+    int size = col_size(C->Type);
+
+    D->Chunk = NULL;
+    D->Skip = 0;
+    D->Stride = size;
+    D->Wrap = D->Span = 0; /* Sample number is the position */
+    D->Data = NULL;
+    if (size == 0)
+        return (1); /* FL_PLOTXY_UNIFORM - nothing stored */
+
+    if (L->DataSize > (unsigned long int)-1 / size ||
+        (D->Data = (char *)malloc(L->DataSize ? L->DataSize * size : 1)) == NULL)
         return (0);
 
-    fprintf(fptr, "X,Y\n");
-
-    /* Write data to the file */
-    for (cnt = 0; cnt < L->DataSize; cnt++)
+    for (first = 0; first < L->DataSize; first += n)
     {
-        fprintf(fptr, "%f,%f\n", D->X, D->Y);
-        D++;
+        n = line_run(L, first, L->DataSize, &p);
+        if (n > col_room(C, p))
+            n = col_room(C, p);
+        if (C->Stride == size)
+            memcpy(D->Data + first * size, col_at(C, p), n * size);
+        else
+        {
+            for (count = 0; count < n; count++)
+                memcpy(D->Data + (first + count) * size, col_at(C, p + count), size);
+        }
     }
-
-    fclose(fptr);
     return (1);
 }
 
 /************************************************************************
-*                           loadxyyy
-* Load using first column as X and remaining columns as Y data
-* This scans for the Maximum number of Y columns
-* First Row is treated as titles for each Axis
-* NOTE: This will Clear ALL data dbefore Loading.
+*                          line_copy
+* A copy of the Y values of L, and the X too if x, for a save to read
+* while L changes. Values keep their type, oldest first.
+* Returns NULL when out of memory.
 ************************************************************************/
-
-char XLabel[41];
-char YLabel[FL_PLOTXY_MAXLINES][41];
-char GraphLineLabel[FL_PLOTXY_MAXLINES][41];
-
-int Fl_PlotXY::loadxyyy(const char *Filename)
+static Fl_PlotXY_Line *line_copy(const Fl_PlotXY_Line *L, int x)
 {
-    FILE *fptr;
-
-    char str[255], *sptr, *sptr2, label[255];
-    int count, H, M, S;
-    int lines[FL_PLOTXY_MAXLINES];
-    int XMode = FL_PLOTXY_VAL_NUMBER; /* X Axis value mode */
-    double xval, yval;
-
-    if (P_DEBUG > 0)
-        printf("Fl_PlotXY::loadxyyy(const char *Filename)\n");
+    Fl_PlotXY_Line *S;
 
-    if (P_DEBUG > 1)
-        printf(" Opening file %s\n", Filename);
-    if ((fptr = fopen(Filename, "r")) == NULL)
+    if ((S = (Fl_PlotXY_Line *)malloc(sizeof(Fl_PlotXY_Line))) == NULL)
+        return (NULL);
+    *S = *L;
+    S->DataStart = 0;
+    S->MaxPoints = 0;
+    S->Segmented = 0;
+    S->External = 0;
+    S->data = NULL;
+    S->Cols = NULL;
+    S->Chunk = NULL;
+    S->Group = NULL;
+    S->Pyramid = NULL;
+    S->XCol.Data = S->YCol.Data = NULL;
+
+    if ((x && !col_copy(&S->XCol, &L->XCol, L)) || !col_copy(&S->YCol, &L->YCol, L))
     {
-        if (P_DEBUG > 1)
-            printf(" ERROR: Could not open %s\n", Filename);
-        return (0);
+        line_uncopy(S);
+        return (NULL);
     }
+    return (S);
+}
 
-    if (P_DEBUG > 1)
-        printf(" File opened Sucessfully\n Removing all Lines\n");
-    removeall();
+static Fl_PlotXY_Job *job_new(Fl_PlotXY *W, int kind, int threads, Fl_Awake_Handler awake)
+{
+    Fl_PlotXY_Job *J;
 
-    if (P_DEBUG > 1)
-        printf(" Reading and decoding Line Titles\n");
+    if ((J = (Fl_PlotXY_Job *)calloc(1, sizeof(Fl_PlotXY_Job))) == NULL)
+        return (NULL);
+    J->W = W;
+    J->Awake = awake;
+    J->Kind = kind;
+    J->Threads = threads;
+    J->Line = J->Group = -1;
+    J->State = FL_PLOTXY_ASYNC_RUNNING;
+#ifdef WIN32
+    InitializeCriticalSection(&J->Lock);
+#else
+    pthread_mutex_init(&J->Lock, NULL);
+#endif
+    SimdJobs++;
+    return (J);
+}
 
-    for (count = 0; count < FL_PLOTXY_MAXLINES; count++)
-        lines[count] = -1; /* Clear all line values */
+/* Everything of a job whose thread has stopped or never started */
+static void job_free(Fl_PlotXY_Job *J)
+{
+    int count;
+
+    rounds_free(J->Head);
+    if (J->Open)
+        file_close(&J->F);
+    for (count = 0; count < J->Copied; count++)
+        line_uncopy(J->Copies[count]);
+    free(J->Copies);
+    free(J->Lines);
+    free(J->Ys);
+    free(J->Name);
+#ifdef WIN32
+    DeleteCriticalSection(&J->Lock);
+#else
+    pthread_mutex_destroy(&J->Lock);
+#endif
+    free(J);
+    SimdJobs--;
+}
 
-    /* First Row is line titles */
-    fgets(str, 254, fptr);
+/* The thread has finished - async_step has to hear, however long the
+ * FLTK queue stays full, unless the widget has gone */
+static void job_end(Fl_PlotXY_Job *J, int state)
+{
+    int waiting;
 
-    /* First Column is X Axis - Skip it*/
+    job_lock(J);
+    J->State = J->Cancel ? FL_PLOTXY_ASYNC_CANCELLED : state;
+    for (;;)
+    {
+        job_post(J);
+        waiting = !J->Posted && J->W != NULL;
+        job_unlock(J);
+        if (!waiting)
+            break;
+#ifdef WIN32
+        Sleep(10);
+#else
+        usleep(10000);
+#endif
+        job_lock(J);
+    }
+}
 
-    if ((sptr = strpbrk(str, ",")) != NULL)
+/************************************************************************
+*                          job_load
+* Parse the rows of the file a few MB a thread at a time, queueing each
+* go for async_step, until the end or asynccancel.
+************************************************************************/
+static void job_load(Fl_PlotXY_Job *J)
+{
+    Fl_PlotXY_Round *N;
+    const char *p = J->Rows, *end = J->F.Data + J->F.Size, *q;
+    unsigned long int size = FL_PLOTXY_ASYNC_PART * (unsigned long int)(J->Threads > 0 ? J->Threads : 1);
+    unsigned long int points;
+    int stop = 0;
+
+    /* Rows there are, for the lines to have room for them all */
+    points = p < end ? text_count(p, end - p, '\n') + 1 : 0;
+    job_lock(J);
+    J->Points = points;
+    job_unlock(J);
+
+    while (p < end && !stop)
     {
-        /* Remaining are Line Labels */
-        for (count = 0; count < FL_PLOTXY_MAXLINES; count++)
+        /* The next go, on to the end of its last row */
+        if ((unsigned long int)(end - p) <= size || (q = (const char *)memchr(p + size, '\n', end - p - size)) == NULL)
+            q = end;
+        else
+            q++;
+
+        if ((N = (Fl_PlotXY_Round *)calloc(1, sizeof(Fl_PlotXY_Round))) == NULL ||
+            (N->R = rows_split(p, q, J->Kind == FL_PLOTXY_JOB_LOAD, J->Columns, J->Threads, &N->Parts)) == NULL)
         {
-            sptr++;
-            sprintf(label, "%s", sptr);
+            free(N);
+            job_end(J, FL_PLOTXY_ASYNC_FAILED);
+            return;
+        }
+        if (N->Parts < 2)
+            rows_part(&N->R[0]); /* Not left to rows_next on the FLTK thread */
+        else
+            rows_run(N->R, N->Parts);
+        p = q;
 
-            if (strlen(label) > 39)
-                label[40] = 0; /* Limit Label size to 40 Characters */
+        job_lock(J);
+        if (J->Tail != NULL)
+            J->Tail->Next = N;
+        else
+            J->Head = N;
+        J->Tail = N;
+        J->Done = p - J->Rows;
+        stop = J->Cancel;
+        job_post(J);
+        job_unlock(J);
+    }
 
-            sprintf(GraphLineLabel[count], "%s", label);
+    job_end(J, FL_PLOTXY_ASYNC_DONE);
+}
 
-            if ((sptr2 = strpbrk(GraphLineLabel[count], ",\n")) != NULL)
-                *sptr2 = 0; /* Terminate the string */
+/* Rows written by a save so far - 0 to stop */
+static int job_more(void *arg, unsigned long int rows)
+{
+    Fl_PlotXY_Job *J = (Fl_PlotXY_Job *)arg;
+    int stop;
+
+    job_lock(J);
+    J->Done = rows;
+    stop = J->Cancel;
+    job_post(J);
+    job_unlock(J);
+    return (!stop);
+}
 
-            /* Create the Line */
-            lines[count] = newline(0, 0, 0, 0, FL_PLOTXY_AUTO, FL_BLACK, GraphLineLabel[count]);
+/* Write the rows of the copies, the file gone if cancelled */
+static void job_save(Fl_PlotXY_Job *J)
+{
+    int ok, stop;
 
-            if (P_DEBUG > 0)
-                printf(" Line label %d = %s \n", lines[count], GraphLineLabel[count]);
+    ok = csv_rows(&J->O, J->XL, J->Copies, J->Copied, J->XTime, J->Threads, job_more, J);
+    ok = out_close(&J->O) && ok;
 
-            if ((sptr = strpbrk(sptr, ",")) == NULL)
-            {
-                count = FL_PLOTXY_MAXLINES;
-            }
-        }
-    }
+    job_lock(J);
+    stop = J->Cancel;
+    job_unlock(J);
+    if (stop)
+        remove(J->Name);
 
-    /* Second Row is Axis Labels */
-    fgets(str, 254, fptr);
+    job_end(J, ok ? FL_PLOTXY_ASYNC_DONE : FL_PLOTXY_ASYNC_FAILED);
+}
 
-    /* First Column is X Axis */
-    sprintf(label, "%s", str);
-    if (strlen(label) > 39)
-        label[40] = 0; /* Limit Label size to 40 Characters */
-    sprintf(XLabel, "%s", label);
+#ifdef WIN32
+static DWORD WINAPI job_thread(LPVOID J)
+{
+    if (((Fl_PlotXY_Job *)J)->Kind == FL_PLOTXY_JOB_SAVE)
+        job_save((Fl_PlotXY_Job *)J);
+    else
+        job_load((Fl_PlotXY_Job *)J);
+    return (0);
+}
+#else
+static void *job_thread(void *J)
+{
+    if (((Fl_PlotXY_Job *)J)->Kind == FL_PLOTXY_JOB_SAVE)
+        job_save((Fl_PlotXY_Job *)J);
+    else
+        job_load((Fl_PlotXY_Job *)J);
+    return (NULL);
+}
+#endif
 
-    if (P_DEBUG > 1)
-        printf(" X Title = %s \n", XLabel);
+static int job_start(Fl_PlotXY_Job *J)
+{
+#ifdef WIN32
+    return ((J->Thread = CreateThread(NULL, 0, job_thread, J, 0, NULL)) != NULL);
+#else
+    return (pthread_create(&J->Thread, NULL, job_thread, J) == 0);
+#endif
+}
 
-    if ((sptr2 = strpbrk(XLabel, ",")) != NULL)
-        *sptr2 = 0;
+static void job_join(Fl_PlotXY_Job *J)
+{
+#ifdef WIN32
+    WaitForSingleObject(J->Thread, INFINITE);
+    CloseHandle(J->Thread);
+#else
+    pthread_join(J->Thread, NULL);
+#endif
+}
 
-    if ((sptr = strpbrk(str, ",")) != NULL)
-    {
-        /* Remaining Titles are Y Axis Columns */
-        for (count = 0; count < FL_PLOTXY_MAXLINES; count++)
-        {
-            sptr++;
-            sprintf(label, "%s", sptr);
-            if (strlen(label) > 39)
-                label[40] = 0; /* Limit Label size to 40 Characters */
-            sprintf(YLabel[count], "%s", label);
+/* The widget is going: stop the thread, and free the job now or, if
+ * Awake is still to be called, then */
+static void job_orphan(Fl_PlotXY_Job *J)
+{
+    int posted;
 
-            if (P_DEBUG > 1)
-                printf(" Y Title = %s \n", YLabel[count]);
+    job_lock(J);
+    J->Cancel = 1;
+    J->W = NULL;
+    job_unlock(J);
 
-            if ((sptr2 = strpbrk(YLabel[count], ",\n")) != NULL)
-                *sptr2 = 0; /* Terminate the string */
+    job_join(J);
 
-            //lines[count]=newline(0,0,0,0,FL_PLOTXY_AUTO,FL_BLACK,YLabel[count]);
+    job_lock(J);
+    posted = J->Posted;
+    job_unlock(J);
+    if (!posted)
+        job_free(J);
+}
 
-            if (P_DEBUG > 1)
-                printf(" Adding Label to line\n");
-            ymarklabel(lines[count], YLabel[count]);
-            xmarklabel(lines[count], XLabel);
+/************************************************************************
+*                          async_awake
+************************************************************************/
+void Fl_PlotXY::async_awake(void *job)
+{
+    Fl_PlotXY_Job *J = (Fl_PlotXY_Job *)job;
 
-            if ((sptr = strpbrk(sptr, ",")) == NULL)
-            {
-                count = FL_PLOTXY_MAXLINES;
-            }
-        }
-    }
+    if (J->W == NULL)
+        job_free(J); /* The widget went, the thread has stopped */
+    else
+        J->W->async_step(J);
+}
 
-    if (P_DEBUG > 1)
-        printf(" Reading Line Data\n");
-    while (!feof(fptr))
+/************************************************************************
+*                          async_step
+* Rows are added as they come with asyncpreview, else all of them once
+* the thread is done - a load changes the lines in one go.
+************************************************************************/
+void Fl_PlotXY::async_step(Fl_PlotXY_Job *J)
+{
+    Fl_PlotXY_Round *N, *list = NULL;
+    Fl_PlotXY_Line *L;
+    unsigned long int points, done, total;
+    int state, count, target;
+
+    job_lock(J);
+    J->Posted = 0;
+    state = J->State;
+    points = J->Points;
+    done = J->Done;
+    total = J->Total;
+    if (AsyncPreview || state != FL_PLOTXY_ASYNC_RUNNING)
     {
-        fgets(str, 254, fptr);
+        list = J->Head;
+        J->Head = J->Tail = NULL;
+    }
+    job_unlock(J);
 
-        if (P_DEBUG > 1)
-            printf(" Checking if Time....\n");
-        if (strpbrk(str, ":") != NULL)
-        {
-            /* Looks like the first column is time..... */
-            if (P_DEBUG > 1)
-                printf(" Decoding time.");
-            H = M = S = 0;
+    if (state != FL_PLOTXY_ASYNC_RUNNING)
+        job_join(J);
 
-            H = atoi(str);
-            if ((sptr = strpbrk(str, ":")) != NULL)
+    if (J->Kind != FL_PLOTXY_JOB_SAVE && (state == FL_PLOTXY_ASYNC_RUNNING || state == FL_PLOTXY_ASYNC_DONE) &&
+        (list != NULL || state == FL_PLOTXY_ASYNC_DONE))
+    {
+        /* The lines, with room for every row */
+        if (!J->Made)
+        {
+            if (J->Kind == FL_PLOTXY_JOB_LOADXYYY)
             {
-                sptr++;
-                M = atoi(sptr);
-                if ((sptr = strpbrk(str, ":")) != NULL)
-                {
-                    sptr++;
-                    S = atoi(sptr);
-                }
+                J->Group = xyyy_lines(J->F.Data, J->F.Data + J->F.Size, J->Lines, J->Columns);
+                if (J->Group >= 0 && points > 0)
+                    group_grow(Groups[J->Group], points);
             }
-            xval = ((double)H * 3600.0) + ((double)M * 60.0) + (double)S;
-            XMode = FL_PLOTXY_VAL_TIMEHMS;
-        }
-        else
-        {
-            if (P_DEBUG > 1)
-                printf(" Plain data found.");
-            /* Get X Value  */
-            xval = atof(str);
+            else
+                reserve(J->Line, points);
+            J->Made = 1;
         }
 
-        /* Go to first comma */
-        if ((sptr = strpbrk(str, ",")) != NULL)
+        /* The lines may have been removed since */
+        target = J->Kind == FL_PLOTXY_JOB_LOAD ? (getselected(J->Line) != NULL ? J->Line : -1)
+                                               : (J->Group >= 0 && J->Group < GroupSlots && Groups[J->Group] != NULL ? J->Group : -1);
+        for (; list != NULL && target >= 0; list = N)
         {
-            /* Decode data to get Y values */
-            for (count = 0; count < FL_PLOTXY_MAXLINES; count++)
-            {
-                sptr = strpbrk(sptr, "01234567890+-."); /* Moving the numerical value on Line */
-                if (sptr == NULL)
-                {
-                    count = FL_PLOTXY_MAXLINES; /* End of the line */
-                }
-                else
-                {
-                    yval = atof(sptr);
-                    add(lines[count], xval, yval); /* Add Data to graph */
-                }
-                if ((sptr = strpbrk(sptr, ",")) == NULL)
-                    count = FL_PLOTXY_MAXLINES;
-            }
+            N = list->Next;
+            if (rows_add(this, target, list->R, list->Parts, J->Ys))
+                J->Time = 1;
+            free(list);
         }
-        else
+        redraw();
+    }
+    rounds_free(list);
+
+    if (state == FL_PLOTXY_ASYNC_RUNNING)
+    {
+        if (AsyncCb != NULL)
+            AsyncCb(this, state, total != 0 ? (double)done / total : 0.0, AsyncArg);
+        return;
+    }
+
+    /* Finished */
+    if (J->Kind == FL_PLOTXY_JOB_LOADXYYY)
+    {
+        if (state == FL_PLOTXY_ASYNC_DONE)
+            xyyy_marks(this, J->Lines, J->Columns, J->Time);
+        else if (J->Made)
         {
-            count = FL_PLOTXY_MAXLINES;
+            for (count = 0; count < J->Columns; count++)
+                remove(J->Lines[count]);
         }
     }
-    /* Set X Axis Value Mode */
-    for (count = 0; count < FL_PLOTXY_MAXLINES; count++)
+    else if (J->Kind == FL_PLOTXY_JOB_LOAD)
     {
-        xvaltype(lines[count], XMode);
-        xmarkon(lines[count], FL_PLOTXY_MARK_ON | FL_PLOTXY_MARK_LABEL | FL_PLOTXY_MARK_NAME);
-        ymarkon(lines[count], FL_PLOTXY_MARK_ON | FL_PLOTXY_MARK_LABEL);
+        if (state != FL_PLOTXY_ASYNC_DONE)
+            remove(J->Line);
+        else if ((L = getselected(J->Line)) != NULL)
+            minmax(L);
     }
 
-    fclose(fptr);
-
+    Job = NULL;
+    job_free(J);
     redraw();
 
-    return (1);
+    if (AsyncCb != NULL)
+        AsyncCb(this, state, state == FL_PLOTXY_ASYNC_DONE ? 1.0 : total != 0 ? (double)done / total : 0.0, AsyncArg);
 }
 
 /************************************************************************
-*                           savexyyy
-* save using first column as X and remaining columns as Y data
-* This scans for the Maximum number of Y columns
-* First Row is titles for each Axis
+*                          loadasync
 ************************************************************************/
-int Fl_PlotXY::savexyyy(const char *Filename)
+int Fl_PlotXY::loadasync(const char *FileName)
 {
-    FILE *fptr;
-    unsigned long int DataCount;
-    int count, H, M, S, h;
-    double X, Y;
+    Fl_PlotXY_Job *J;
 
     if (P_DEBUG > 2)
-        printf("Fl_PlotXY::savexyyy(const char *Filename)\n");
+        printf("Fl_PlotXY::loadasync(const char *FileName)\n");
 
-    if (P_DEBUG > 1)
-        printf(" Opening file %s\n", Filename);
-    if ((fptr = fopen(Filename, "w")) == NULL)
+    if (Job != NULL ||
+        (J = job_new(this, FL_PLOTXY_JOB_LOAD, LoadThreads ? LoadThreads : load_cpus(), async_awake)) == NULL)
+        return (-1);
+
+    if (!(J->Open = file_open(&J->F, FileName, 1)) || (J->Line = newline()) == -1)
+    {
+        job_free(J);
+        return (-1);
+    }
+    J->Rows = J->F.Data;
+    J->Columns = 1;
+    J->Total = J->F.Size;
+
+    if (!job_start(J))
+    {
+        remove(J->Line);
+        job_free(J);
+        return (-1);
+    }
+    Job = J;
+    return (J->Line);
+}
+
+/************************************************************************
+*                          loadxyyyasync
+************************************************************************/
+int Fl_PlotXY::loadxyyyasync(const char *Filename)
+{
+    Fl_PlotXY_Job *J;
+
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::loadxyyyasync(const char *Filename)\n");
+
+    if (Job != NULL ||
+        (J = job_new(this, FL_PLOTXY_JOB_LOADXYYY, LoadThreads ? LoadThreads : load_cpus(), async_awake)) == NULL)
+        return (0);
+
+    if (!(J->Open = file_open(&J->F, Filename, 1)))
     {
         if (P_DEBUG > 1)
             printf(" ERROR: Could not open %s\n", Filename);
+        job_free(J);
         return (0);
     }
+    J->Columns = xyyy_columns(J->F.Data, J->F.Data + J->F.Size, &J->Rows);
+    J->Total = J->F.Data + J->F.Size - J->Rows;
 
-    /* Skip first column*/
-    fprintf(fptr, "X");
-
-    /* Write Y Line Names */
-    for (count = 0; count < FL_PLOTXY_MAXLINES; count++)
+    if ((J->Lines = (int *)malloc((J->Columns + 1) * sizeof(int))) == NULL ||
+        (J->Ys = (const double **)malloc((J->Columns + 1) * sizeof(double *))) == NULL || !job_start(J))
     {
-        if (used(count) == 1)
-        {
-            fprintf(fptr, ",%s", linetitle(count));
-        }
+        job_free(J);
+        return (0);
     }
-    fprintf(fptr, "\n");
+    Job = J;
+    return (1);
+}
 
-    /* Write X Axis titles */
-    fprintf(fptr, "%s", xmarklabel(0));
+/************************************************************************
+*                          saveasync
+************************************************************************/
+int Fl_PlotXY::saveasync(int line, const char *FileName)
+{
+    Fl_PlotXY_Job *J;
+    Fl_PlotXY_Line *L;
 
-    /* Write Y Axis titles */
-    for (count = 0; count < FL_PLOTXY_MAXLINES; count++)
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::saveasync(int line,const char *FileName)\n");
+
+    if (Job != NULL || (L = getselected(line)) == NULL ||
+        (J = job_new(this, FL_PLOTXY_JOB_SAVE, LoadThreads ? LoadThreads : load_cpus(), async_awake)) == NULL)
+        return (0);
+
+    /* The points as they are now */
+    if ((J->Copies = (Fl_PlotXY_Line **)calloc(1, sizeof(Fl_PlotXY_Line *))) == NULL ||
+        (J->Copies[J->Copied++] = line_copy(L, 1)) == NULL ||
+        (J->Name = (char *)malloc(strlen(FileName) + 1)) == NULL)
     {
-        if (used(count) == 1)
-        {
-            fprintf(fptr, ",%s", ymarklabel(count));
-        }
+        job_free(J);
+        return (0);
     }
-    fprintf(fptr, "\n");
+    strcpy(J->Name, FileName);
+    J->XL = J->Copies[0];
+    J->Total = L->DataSize;
 
-    /* Write the X, Y values */
-    for (DataCount = 0; DataCount < datasize(0); DataCount++)
+    if (!out_open(&J->O, FileName))
     {
-        X = 0;
-        /* Write X Value */
-        read(0, DataCount, &X, &Y);
+        job_free(J);
+        return (0);
+    }
+    out_text(&J->O, "X,Y\n");
 
-        switch (xvaltype(0))
-        {
-        default:
-        case FL_PLOTXY_VAL_NUMBER:
-            fprintf(fptr, "%lf", X);
-            break;
+    if (!job_start(J))
+    {
+        out_close(&J->O);
+        ::remove(FileName);
+        job_free(J);
+        return (0);
+    }
+    Job = J;
+    return (1);
+}
 
-        case FL_PLOTXY_VAL_TIMEHM:
-        case FL_PLOTXY_VAL_TIMEHMS:
-        case FL_PLOTXY_VAL_TIMEHMSh:
-            H = (int)(X / 3600); /* Calc Hours */
-            X -= (double)(H * 3600);
-            M = (int)(X / 60); /* Calc Minutes */
-            X -= (double)(M * 60);
-            S = (int)X; /* Calc Seconds */
-            X -= (double)S;
-            h = (int)(X * 100); /* Calc hundreths */
+/************************************************************************
+*                          savexyyyasync
+************************************************************************/
+int Fl_PlotXY::savexyyyasync(const char *Filename)
+{
+    Fl_PlotXY_Job *J;
+    Fl_PlotXY_Line *L, *XL, **lines;
+    int count, used_lines, ok;
 
-            fprintf(fptr, "%02d:%02d:%02d.%02d", H, M, S, h);
-            break;
-        }
+    if (P_DEBUG > 2)
+        printf("Fl_PlotXY::savexyyyasync(const char *Filename)\n");
 
-        /* Write Y Axis values */
-        for (count = 0; count < FL_PLOTXY_MAXLINES; count++)
-        {
-            if (used(count) == 1)
-            {
-                Y = 0;
-                read(count, DataCount, &X, &Y);
-                fprintf(fptr, ",%lf", Y);
-            }
-        }
-        fprintf(fptr, "\n");
+    if (Job != NULL ||
+        (J = job_new(this, FL_PLOTXY_JOB_SAVE, LoadThreads ? LoadThreads : load_cpus(), async_awake)) == NULL)
+        return (0);
+
+    /* The lines to write, and their points as they are now */
+    lines = (Fl_PlotXY_Line **)malloc((LineSlots + 1) * sizeof(Fl_PlotXY_Line *));
+    J->Copies = (Fl_PlotXY_Line **)calloc(LineSlots + 1, sizeof(Fl_PlotXY_Line *));
+    J->Name = (char *)malloc(strlen(Filename) + 1);
+    ok = lines != NULL && J->Copies != NULL && J->Name != NULL;
+
+    used_lines = 0;
+    XL = getselected(0); /* X values come from line 0 */
+    for (count = 0; ok && count < LineSlots; count++)
+    {
+        if ((L = getselected(count)) == NULL)
+            continue;
+        lines[used_lines++] = L;
+        ok = (J->Copies[J->Copied++] = line_copy(L, L == XL)) != NULL;
     }
 
-    fclose(fptr);
+    if (!ok || !out_open(&J->O, Filename))
+    {
+        free(lines);
+        job_free(J);
+        return (0);
+    }
+    strcpy(J->Name, Filename);
+    J->XL = XL != NULL ? J->Copies[0] : NULL;
+    J->XTime = csv_time(XL);
+    J->Total = XL != NULL ? XL->DataSize : 0;
+
+    csv_head(&J->O, lines, used_lines, xmarklabel(0));
+    free(lines);
+
+    if (!job_start(J))
+    {
+        out_close(&J->O);
+        ::remove(Filename);
+        job_free(J);
+        return (0);
+    }
+    Job = J;
     return (1);
 }
+
+/************************************************************************
+*                          asynccancel
+************************************************************************/
+void Fl_PlotXY::asynccancel(void)
+{
+    if (Job == NULL)
+        return;
+
+    job_lock(Job);
+    Job->Cancel = 1;
+    job_unlock(Job);
+}